@@ -210,6 +210,13 @@ static void writeHeaderIncludes(const Class& classData, Class::Role role,
             forwards.insertString("class TQDomElement");
             if (!classData.msignals.isEmpty())
                 forwards.insertString("class TQString");
+            if (!classData.properties.isEmpty())
+            {
+                includes["TQt"].insertString("<tqstringlist.h>");
+                includes["tqdbus"].insertString("<tqdbusdatamap.h>");
+                forwards.insertString("class TQT_DBusMessage");
+                forwards.insertString("class TQT_DBusVariant");
+            }
             if (!classData.asyncMethods.isEmpty())
             {
                 includes["TQt"].insertString("<tqmap.h>");
@@ -331,6 +338,14 @@ static void writeSourceIncludes(const Class& classData, Class::Role role,
             includes["TQt"].insertString("<tqdom.h>");
             includes["tqdbus"].insertString("<tqdbuserror.h>");
             includes["tqdbus"].insertString("<tqdbusmessage.h>");
+            if (!classData.properties.isEmpty())
+            {
+                includes["TQt"].insertString("<tqapplication.h>");
+                includes["TQt"].insertString("<tqobject.h>");
+                includes["tqdbus"].insertString("<tqdbusdata.h>");
+                includes["tqdbus"].insertString("<tqdbusdatalist.h>");
+                includes["tqdbus"].insertString("<tqdbusvariant.h>");
+            }
             break;
 
         case Class::Proxy:
@@ -408,7 +423,25 @@ static void openClassDeclaration(const Class& classData,
                    << endl;
             stream << "{" << endl;
             stream << "public:" << endl;
-            stream << "    virtual ~" << classData.name << "() {}" << endl;
+            if (!classData.asyncReplyMethods.isEmpty() || !classData.properties.isEmpty())
+            {
+                stream << "    " << classData.name << "()";
+
+                TQString separator = " : ";
+                if (!classData.asyncReplyMethods.isEmpty())
+                {
+                    stream << separator << "m_nextAsyncCallId(0)";
+                    separator = ", ";
+                }
+                if (!classData.properties.isEmpty())
+                    stream << separator << "m_propertiesTracker(0)";
+
+                stream << " {}" << endl;
+            }
+            if (classData.properties.isEmpty())
+                stream << "    virtual ~" << classData.name << "() {}" << endl;
+            else
+                stream << "    virtual ~" << classData.name << "();" << endl;
             stream << endl;
             stream << "    static void buildIntrospectionData(TQDomElement& interfaceElement);" << endl;
             break;
@@ -467,6 +500,18 @@ static void closeClassDeclaration(const Class& classData, Class::Role role,
     switch (role)
     {
         case Class::Interface:
+            if (!classData.properties.isEmpty())
+            {
+                stream << "protected: // usually no need to reimplement" << endl;
+                stream << "    virtual bool handlePropertiesCall(const TQT_DBusMessage& message);"
+                       << endl;
+                stream << endl;
+                stream << "private:" << endl;
+                stream << "    class PropertiesTracker;" << endl;
+                stream << "    PropertiesTracker* m_propertiesTracker;" << endl;
+                stream << endl;
+                stream << "    TQStringList m_changedProperties;" << endl;
+            }
             break;
 
         case Class::Proxy:
@@ -576,9 +621,27 @@ static void writeMethodDeclarations(const Class& classData, Class::Role role,
         switch (role)
         {
             case Class::Interface:
-                tqWarning("Properties not yet supported for interfaces");
-                skip = true;
                 pureVirtual = true;
+                stream << "public:" << endl;
+                stream << "    virtual bool getDBusProperty(const TQString& name,"
+                       << " TQT_DBusVariant& variant, TQT_DBusError& error) const;"
+                       << endl;
+                stream << "    virtual bool setDBusProperty(const TQString& name,"
+                       << " const TQT_DBusVariant& variant, TQT_DBusError& error);"
+                       << endl;
+                stream << "    virtual bool getAllDBusProperties("
+                       << "TQT_DBusDataMap<TQString>& values, TQT_DBusError& error) const;"
+                       << endl;
+                stream << endl;
+                stream << "    // emits the changes collected by markPropertyChanged() now"
+                       << endl;
+                stream << "    void flushPropertiesChanged();" << endl;
+                stream << endl;
+                stream << "protected: // for collecting changes into one PropertiesChanged signal"
+                       << endl;
+                stream << "    void markPropertyChanged(const TQString& name);" << endl;
+                stream << endl;
+                stream << "protected: // implement property access" << endl;
                 break;
 
             case Class::Proxy:
@@ -589,6 +652,11 @@ static void writeMethodDeclarations(const Class& classData, Class::Role role,
                        << endl;
                 stream << "    virtual TQT_DBusVariant getDBusProperty(const TQString& name, TQT_DBusError& error) const;" << endl;
                 stream << endl;
+                stream << "    void setPropertyCacheEnabled(bool enabled);" << endl;
+                stream << "    bool isPropertyCacheEnabled() const;" << endl;
+                stream << "    uint propertyCacheHits() const;" << endl;
+                stream << "    uint propertyCacheMisses() const;" << endl;
+                stream << endl;
                 break;
 
             case Class::Node: // no node properties
@@ -610,7 +678,8 @@ static void writeMethodDeclarations(const Class& classData, Class::Role role,
     switch (role)
     {
         case Class::Interface:
-            if (!classData.methods.isEmpty() || !classData.asyncMethods.isEmpty())
+            if (!classData.methods.isEmpty() || !classData.asyncMethods.isEmpty() ||
+                !classData.properties.isEmpty())
             {
                 stream << "protected: // implement sending replies" << endl;
                 stream << "    virtual void handleMethodReply(const TQT_DBusMessage& reply) = 0;" << endl;
@@ -666,7 +735,11 @@ static void writeMethodDeclarations(const Class& classData, Class::Role role,
 static void writeSignalDeclarations(const Class& classData, Class::Role role,
         TQTextStream& stream)
 {
-    if (classData.msignals.isEmpty() && classData.asyncReplySignals.isEmpty())
+    bool hasSignals =
+        !classData.msignals.isEmpty() || !classData.asyncReplySignals.isEmpty();
+
+    // property changes are sent as signals as well
+    if (!hasSignals && (role != Class::Interface || classData.properties.isEmpty()))
         return;
 
     TQString prefix;
@@ -677,6 +750,8 @@ static void writeSignalDeclarations(const Class& classData, Class::Role role,
             stream << "    virtual bool handleSignalSend(const TQT_DBusMessage& reply) = 0;" << endl;
             stream << "    virtual TQString objectPath() const = 0;" << endl;
             stream << endl;
+            if (!hasSignals) return;
+
             stream << "protected: // for sending D-Bus signals" << endl;
             prefix = "    virtual bool emit";
             break;
@@ -747,6 +822,7 @@ static void writeMethodCallDeclarations(const Class& classData,
     {
         stream << "protected:" << endl;
         stream << "    TQMap<int, TQT_DBusMessage> m_asyncCalls;" << endl;
+        stream << "    int m_nextAsyncCallId;" << endl;
         stream << endl;
     }
 }
@@ -1031,6 +1107,7 @@ bool ClassGenerator::generateInterface(const Class& classData,
     writeInterfaceAsyncReplyHandlers(classDataCopy, sourceStream);
     writeMethodCalls(classDataCopy, sourceStream);
 
+    MethodGenerator::writeInterfaceProperties(classDataCopy, sourceStream);
     MethodGenerator::writeInterfaceMainMethod(classDataCopy, sourceStream);
 
     closeNamespaces(classDataCopy.namespaces, sourceStream);
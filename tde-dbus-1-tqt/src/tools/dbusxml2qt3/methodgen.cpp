@@ -377,8 +377,10 @@ static TQValueList<Argument> extractArguments(const TQDomElement& methodElement,
     return arguments;
 }
 
+// failure holds the statements executed when an annotated argument cannot
+// be read from the message, "%1" is replaced by the TQT_DBusError to report
 static void writeVariable(const Argument& argument, uint index,
-        const TQString& prefix, TQTextStream& stream)
+        const TQString& prefix, const TQStringList& failure, TQTextStream& stream)
 {
     stream << prefix << argument.signature << " _" << argument.name;
     if (argument.direction == Argument::In)
@@ -387,11 +389,27 @@ static void writeVariable(const Argument& argument, uint index,
         {
             stream << ";" << endl;
 
-            // TODO: error handling?
-            stream << prefix << "TQT_DBusDataConverter::convertFromTQT_DBusData<"
-                   << argument.annotatedType
-                   << TQString(">(message[%1], _").arg(index)
-                   << argument.name << ")";
+            stream << prefix << "if (message.read<" << argument.annotatedType
+                   << TQString(">(%1, _").arg(index) << argument.name
+                   << ") != TQT_DBusDataConverter::Success)" << endl;
+            stream << prefix << "{" << endl;
+
+            const TQString error =
+                TQString("TQT_DBusError::stdInvalidArgs(\"Cannot demarshall argument '%1'\")")
+                    .arg(argument.name);
+
+            TQStringList::const_iterator it    = failure.begin();
+            TQStringList::const_iterator endIt = failure.end();
+            for (; it != endIt; ++it)
+            {
+                if ((*it).find("%1") != -1)
+                    stream << prefix << "    " << (*it).arg(error) << endl;
+                else
+                    stream << prefix << "    " << *it << endl;
+            }
+
+            stream << prefix << "}" << endl;
+            return;
         }
         else if (!argument.accessor.isEmpty())
         {
@@ -413,14 +431,14 @@ static void writeVariable(const Argument& argument, uint index,
 }
 
 static void writeVariables(const TQString& prefix, const Method& method,
-        TQTextStream& stream)
+        const TQStringList& failure, TQTextStream& stream)
 {
     uint count = 0;
     TQValueList<Argument>::const_iterator it    = method.arguments.begin();
     TQValueList<Argument>::const_iterator endIt = method.arguments.end();
     for (; it != endIt; ++it)
     {
-        writeVariable(*it, count, prefix, stream);
+        writeVariable(*it, count, prefix, failure, stream);
 
         if ((*it).direction == Argument::In) ++count;
     }
@@ -786,7 +804,11 @@ void MethodGenerator::writeMethodCall(const Class& classData,
         Method reducedMethod = method;
         reducedMethod.arguments.pop_front();
 
-        writeVariables("    ", reducedMethod, stream);
+        TQStringList failure;
+        failure << "handleMethodReply(TQT_DBusMessage::methodError(message, %1));";
+        failure << "return;";
+
+        writeVariables("    ", reducedMethod, failure, stream);
     }
     else
     {
@@ -794,19 +816,27 @@ void MethodGenerator::writeMethodCall(const Class& classData,
         stream << "    TQT_DBusMessage reply;" << endl;
         stream << endl;
 
-        writeVariables("    ", method, stream);
+        TQStringList failure;
+        failure << "return TQT_DBusMessage::methodError(message, %1);";
+
+        writeVariables("    ", method, failure, stream);
     }
 
     stream << endl;
 
     if (method.async)
     {
-        stream << "    int _asyncCallId = 0;" << endl;
+        // ids are handed out in sequence, only after the counter wrapped
+        // around can an id still be in use
+        stream << "    int _asyncCallId = m_nextAsyncCallId;" << endl;
         stream << "    while (m_asyncCalls.find(_asyncCallId) != m_asyncCalls.end())"
                << endl;
         stream << "    {" << endl;
-        stream << "        ++_asyncCallId;" << endl;
+        stream << "        _asyncCallId = (_asyncCallId == 0x7fffffff) ? 0 : _asyncCallId + 1;"
+               << endl;
         stream << "    }" << endl;
+        stream << "    m_nextAsyncCallId = (_asyncCallId == 0x7fffffff) ? 0 : _asyncCallId + 1;"
+               << endl;
         stream << "    m_asyncCalls.insert(_asyncCallId, message);" << endl;
         stream << endl;
 
@@ -849,12 +879,15 @@ void MethodGenerator::writeMethodCall(const Class& classData,
         {
             if (!(*it).annotatedType.isEmpty())
             {
-                stream << "        TQT_DBusData " << (*it).name << "Data;" << endl;
-                stream << "        TQT_DBusDataConverter::convertToTQT_DBusData<"
-                       << (*it).annotatedType << ">(_"
-                       << (*it).name << ", " << (*it).name << "Data);"
-                       << endl;
-                stream << "        reply << " << (*it).name << "Data";
+                stream << "        if (reply.append<" << (*it).annotatedType
+                       << ">(_" << (*it).name
+                       << ") != TQT_DBusDataConverter::Success)" << endl;
+                stream << "        {" << endl;
+                stream << "            return TQT_DBusMessage::methodError(message, "
+                       << "TQT_DBusError::stdInvalidArgs(\"Cannot marshall argument '"
+                       << (*it).name << "'\"));" << endl;
+                stream << "        }" << endl;
+                continue;
             }
             else if (!(*it).accessor.isEmpty())
             {
@@ -979,14 +1012,10 @@ void MethodGenerator::writeSignalEmitter(const Class& classData,
     {
         if (!(*it).annotatedType.isEmpty())
         {
-            // TODO: error handling
-            stream << "    TQT_DBusData " << (*it).name << "Data;" << endl;
-            stream << "    if (TQT_DBusDataConverter:convertToTQT_DBusData<"
-                   << (*it).annotatedType << ">("
-                   << (*it).name << ", " << (*it).name << "Data"
-                   << ") != TQT_DBusDataConverter::Success) return false;"
-                   << endl;
-            stream << "    message << " << (*it).name << "Data";
+            // marshalled directly, without an intermediate TQT_DBusData
+            stream << "    if (message.append<" << (*it).annotatedType << ">("
+                   << (*it).name << ") != TQT_DBusDataConverter::Success) "
+                   << "return false";
         }
         else if (!(*it).accessor.isEmpty())
         {
@@ -1059,15 +1088,16 @@ void MethodGenerator::writeInterfaceAsyncReplyHandler(const Class& classData,
     {
         if (!(*it).annotatedType.isEmpty())
         {
-            stream << "    TQT_DBusData " << (*it).name << "Data;" << endl;
-
-            // TODO error handling
-            stream << "    if (TQT_DBusDataConverter::convertToTQT_DBusData<"
-                   << (*it).annotatedType << ">(" << (*it).name << ", "
-                   << (*it).name << "Data"
-                   << ") != TQT_DBusDataConverter::Success) return false;"
+            stream << "    if (reply.append<" << (*it).annotatedType << ">("
+                   << (*it).name << ") != TQT_DBusDataConverter::Success)"
                    << endl;
-            stream << "    reply << " << (*it).name << "Data;" << endl;
+            stream << "    {" << endl;
+            stream << "        reply = TQT_DBusMessage::methodError(call, "
+                   << "TQT_DBusError::stdInvalidArgs(\"Cannot marshall argument '"
+                   << (*it).name << "'\"));" << endl;
+            stream << "        handleMethodReply(reply);" << endl;
+            stream << "        return;" << endl;
+            stream << "    }" << endl;
         }
         else if (!(*it).accessor.isEmpty())
         {
@@ -1112,44 +1142,422 @@ void MethodGenerator::writeInterfaceAsyncReplyHandler(const Class& classData,
     stream << endl;
 }
 
+// FNV-1a over the UTF-16 code units of a member name. The generated
+// handleMethodCall() computes the same hash at runtime and switches on it,
+// so adding methods to an interface does not add string comparisons
+static TQ_UINT32 memberHash(const TQString& name)
+{
+    TQ_UINT32 hash = 2166136261U;
+    for (uint i = 0; i < name.length(); ++i)
+    {
+        hash ^= name[i].unicode();
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
 void MethodGenerator::writeInterfaceMainMethod(const Class& classData,
         TQTextStream& stream)
 {
-    if (classData.methods.isEmpty()) return;
+    if (classData.methods.isEmpty() && classData.properties.isEmpty()) return;
 
     stream << "bool " << classData.name
            << "::handleMethodCall(const TQT_DBusMessage& message)" << endl;
     stream << "{" << endl;
 
+    if (!classData.properties.isEmpty())
+    {
+        stream << "    if (message.interface() == "
+               << "\"org.freedesktop.DBus.Properties\")" << endl;
+        stream << "        return handlePropertiesCall(message);" << endl;
+        stream << endl;
+    }
+
     stream << "    if (message.interface() != \"" << classData.dbusName
            << "\") return false;" << endl;
     stream << endl;
 
+    if (classData.methods.isEmpty())
+    {
+        stream << "    return false;" << endl;
+        stream << "}" << endl;
+        stream << endl;
+        return;
+    }
+
+    // methods grouped by hash, colliding names share a case label
+    TQMap<TQ_UINT32, TQValueList<Method> > methodsByHash;
+
     TQValueList<Method>::const_iterator it    = classData.methods.begin();
     TQValueList<Method>::const_iterator endIt = classData.methods.end();
     for (; it != endIt; ++it)
     {
-        stream << "    if (message.member() == \"" << (*it).name << "\")" << endl;
-        stream << "    {" << endl;
+        methodsByHash[memberHash((*it).name)].append(*it);
+    }
 
-        if ((*it).async)
+    stream << "    const TQString member = message.member();" << endl;
+    stream << endl;
+    stream << "    TQ_UINT32 hash = 2166136261U;" << endl;
+    stream << "    for (uint i = 0; i < member.length(); ++i)" << endl;
+    stream << "    {" << endl;
+    stream << "        hash ^= member[i].unicode();" << endl;
+    stream << "        hash *= 16777619U;" << endl;
+    stream << "    }" << endl;
+    stream << endl;
+
+    stream << "    switch (hash)" << endl;
+    stream << "    {" << endl;
+
+    TQMap<TQ_UINT32, TQValueList<Method> >::const_iterator hashIt    = methodsByHash.begin();
+    TQMap<TQ_UINT32, TQValueList<Method> >::const_iterator hashEndIt = methodsByHash.end();
+    for (; hashIt != hashEndIt; ++hashIt)
+    {
+        stream << "        case 0x" << TQString::number(hashIt.key(), 16) << "U:" << endl;
+
+        it    = hashIt.data().begin();
+        endIt = hashIt.data().end();
+        for (; it != endIt; ++it)
         {
-            stream << "        call" << (*it).name << "Async(message);" << endl;
-            stream << endl;
+            stream << "            if (member == \"" << (*it).name << "\")" << endl;
+            stream << "            {" << endl;
+
+            if ((*it).async)
+            {
+                stream << "                call" << (*it).name << "Async(message);" << endl;
+                stream << endl;
+            }
+            else
+            {
+                stream << "                TQT_DBusMessage reply = call" << (*it).name
+                       << "(message);" << endl;
+                stream << "                handleMethodReply(reply);" << endl;
+                stream << endl;
+            }
+            stream << "                return true;" << endl;
+            stream << "            }" << endl;
+        }
+
+        stream << "            break;" << endl;
+        stream << endl;
+    }
+
+    stream << "        default:" << endl;
+    stream << "            break;" << endl;
+    stream << "    }" << endl;
+    stream << endl;
+
+    stream << "    return false; " << endl;
+    stream << "}" << endl;
+    stream << endl;
+}
+
+static void writePropertyToVariant(const Property& property,
+        const TQString& indent, TQTextStream& stream)
+{
+    if (!property.annotatedType.isEmpty())
+    {
+        stream << indent << "if (TQT_DBusDataConverter::convertToTQT_DBusData<"
+               << property.annotatedType << ">(value, variant.value) != "
+               << "TQT_DBusDataConverter::Success)" << endl;
+        stream << indent << "{" << endl;
+        stream << indent << "    error = TQT_DBusError::stdInvalidArgs("
+               << "TQString(\"Unable to convert value of property '"
+               << property.name << "' to type '" << property.dbusSignature
+               << "'\"));" << endl;
+        stream << indent << "    return false;" << endl;
+        stream << indent << "}" << endl;
+    }
+    else if (!property.accessor.isEmpty())
+    {
+        stream << indent << "variant.value = TQT_DBusData::from"
+               << property.accessor << "(";
+
+        if (property.subAccessor.isEmpty())
+            stream << "value";
+        else
+            stream << property.containerClass << "(value)";
+
+        stream << ");" << endl;
+    }
+    else
+        stream << indent << "variant.value = TQT_DBusData(value);" << endl;
+
+    stream << indent << "variant.signature = \"" << property.dbusSignature
+           << "\";" << endl;
+}
+
+static void writePropertyFromVariant(const Property& property,
+        const TQString& indent, TQTextStream& stream)
+{
+    if (!property.annotatedType.isEmpty())
+    {
+        stream << indent << property.signature << " value;" << endl;
+        stream << indent << "bool ok = TQT_DBusDataConverter::convertFromTQT_DBusData<"
+               << property.annotatedType << ">(variant.value, value) == "
+               << "TQT_DBusDataConverter::Success;" << endl;
+    }
+    else if (!property.accessor.isEmpty())
+    {
+        stream << indent << "bool ok = false;" << endl;
+
+        if (property.subAccessor.isEmpty())
+        {
+            stream << indent << property.signature << " value = "
+                   << "variant.value.to" << property.accessor << "(&ok);"
+                   << endl;
         }
         else
         {
-            stream << "        TQT_DBusMessage reply = call" << (*it).name
-                   << "(message);" << endl;
-            stream << "        handleMethodReply(reply);" << endl;
-            stream << endl;
+            stream << indent << "bool subOK = false;" << endl;
+            stream << indent << property.signature << " value = "
+                   << "variant.value.to" << property.accessor
+                   << "(&ok).to" << property.subAccessor << "(&subOK);"
+                   << endl;
+            stream << indent << "ok = ok && subOK;" << endl;
         }
+    }
+    else
+    {
+        stream << indent << "bool ok = true;" << endl;
+        stream << indent << property.signature << " value = variant.value;"
+               << endl;
+    }
+}
+
+void MethodGenerator::writeInterfaceProperties(const Class& classData,
+        TQTextStream& stream)
+{
+    if (classData.properties.isEmpty()) return;
+
+    // posts an event to itself for emitting the collected changes once the
+    // event loop is reached again. Does not need moc
+    stream << "class " << classData.name << "::PropertiesTracker : public TQObject"
+           << endl;
+    stream << "{" << endl;
+    stream << "public:" << endl;
+    stream << "    PropertiesTracker(" << classData.name << "* interface)"
+           << " : m_interface(interface) {}" << endl;
+    stream << endl;
+    stream << "protected:" << endl;
+    stream << "    virtual void customEvent(TQCustomEvent*)" << endl;
+    stream << "    {" << endl;
+    stream << "        m_interface->flushPropertiesChanged();" << endl;
+    stream << "    }" << endl;
+    stream << endl;
+    stream << "private:" << endl;
+    stream << "    " << classData.name << "* m_interface;" << endl;
+    stream << "};" << endl;
+    stream << endl;
+
+    stream << classData.name << "::~" << classData.name << "()" << endl;
+    stream << "{" << endl;
+    stream << "    delete m_propertiesTracker;" << endl;
+    stream << "}" << endl;
+    stream << endl;
+
+    stream << "bool " << classData.name
+           << "::getDBusProperty(const TQString& name, TQT_DBusVariant& variant, "
+           << "TQT_DBusError& error) const" << endl;
+    stream << "{" << endl;
+
+    TQValueList<Property>::const_iterator it    = classData.properties.begin();
+    TQValueList<Property>::const_iterator endIt = classData.properties.end();
+    for (; it != endIt; ++it)
+    {
+        if (!(*it).read) continue;
+
+        stream << "    if (name == \"" << (*it).name << "\")" << endl;
+        stream << "    {" << endl;
+        stream << "        " << (*it).signature << " value = get" << (*it).name
+               << "(error);" << endl;
+        stream << "        if (error.isValid()) return false;" << endl;
+        stream << endl;
+        writePropertyToVariant(*it, "        ", stream);
+        stream << endl;
         stream << "        return true;" << endl;
         stream << "    }" << endl;
         stream << endl;
     }
 
-    stream << "    return false; " << endl;
+    stream << "    error = TQT_DBusError::stdInvalidArgs("
+           << "TQString(\"No readable property '%1' in interface '"
+           << classData.dbusName << "'\").arg(name));" << endl;
+    stream << "    return false;" << endl;
+    stream << "}" << endl;
+    stream << endl;
+
+    stream << "bool " << classData.name
+           << "::setDBusProperty(const TQString& name, const TQT_DBusVariant& variant, "
+           << "TQT_DBusError& error)" << endl;
+    stream << "{" << endl;
+
+    for (it = classData.properties.begin(); it != endIt; ++it)
+    {
+        if (!(*it).write) continue;
+
+        stream << "    if (name == \"" << (*it).name << "\")" << endl;
+        stream << "    {" << endl;
+        writePropertyFromVariant(*it, "        ", stream);
+        stream << "        if (!ok)" << endl;
+        stream << "        {" << endl;
+        stream << "            error = TQT_DBusError::stdInvalidArgs("
+               << "TQString(\"Invalid value of type '%1' for property '"
+               << (*it).name << "'\").arg(variant.signature));" << endl;
+        stream << "            return false;" << endl;
+        stream << "        }" << endl;
+        stream << endl;
+        stream << "        set" << (*it).name << "(value, error);" << endl;
+        stream << "        if (error.isValid()) return false;" << endl;
+        stream << endl;
+        stream << "        markPropertyChanged(name);" << endl;
+        stream << "        return true;" << endl;
+        stream << "    }" << endl;
+        stream << endl;
+    }
+
+    stream << "    error = TQT_DBusError::stdInvalidArgs("
+           << "TQString(\"No writable property '%1' in interface '"
+           << classData.dbusName << "'\").arg(name));" << endl;
+    stream << "    return false;" << endl;
+    stream << "}" << endl;
+    stream << endl;
+
+    stream << "bool " << classData.name
+           << "::getAllDBusProperties(TQT_DBusDataMap<TQString>& values, "
+           << "TQT_DBusError& error) const" << endl;
+    stream << "{" << endl;
+    stream << "    values = TQT_DBusDataMap<TQString>(TQT_DBusData::Variant);" << endl;
+
+    bool firstRead = true;
+    for (it = classData.properties.begin(); it != endIt; ++it)
+    {
+        if (!(*it).read) continue;
+
+        stream << endl;
+        if (firstRead)
+        {
+            firstRead = false;
+            stream << "    TQT_DBusVariant variant;" << endl;
+        }
+
+        stream << "    if (!getDBusProperty(\"" << (*it).name
+               << "\", variant, error)) return false;" << endl;
+        stream << "    values.insert(\"" << (*it).name
+               << "\", TQT_DBusData::fromVariant(variant));" << endl;
+    }
+
+    if (firstRead) stream << "    Q_UNUSED(error);" << endl;
+
+    stream << endl;
+    stream << "    return true;" << endl;
+    stream << "}" << endl;
+    stream << endl;
+
+    stream << "void " << classData.name << "::flushPropertiesChanged()" << endl;
+    stream << "{" << endl;
+    stream << "    if (m_changedProperties.isEmpty()) return;" << endl;
+    stream << endl;
+    stream << "    TQStringList names = m_changedProperties;" << endl;
+    stream << "    m_changedProperties.clear();" << endl;
+    stream << endl;
+    stream << "    TQString path = objectPath();" << endl;
+    stream << "    if (path.isEmpty()) return;" << endl;
+    stream << endl;
+    stream << "    TQT_DBusDataMap<TQString> changed(TQT_DBusData::Variant);" << endl;
+    stream << "    TQStringList invalidated;" << endl;
+    stream << endl;
+    stream << "    TQStringList::const_iterator it    = names.begin();" << endl;
+    stream << "    TQStringList::const_iterator endIt = names.end();" << endl;
+    stream << "    for (; it != endIt; ++it)" << endl;
+    stream << "    {" << endl;
+    stream << "        TQT_DBusVariant variant;" << endl;
+    stream << "        TQT_DBusError error;" << endl;
+    stream << "        if (getDBusProperty(*it, variant, error))" << endl;
+    stream << "            changed.insert(*it, TQT_DBusData::fromVariant(variant));" << endl;
+    stream << "        else" << endl;
+    stream << "            invalidated.append(*it);" << endl;
+    stream << "    }" << endl;
+    stream << endl;
+    stream << "    TQT_DBusMessage message = TQT_DBusMessage::signal(path, "
+           << "\"org.freedesktop.DBus.Properties\", \"PropertiesChanged\");" << endl;
+    stream << endl;
+    stream << "    message << TQT_DBusData::fromString(\"" << classData.dbusName
+           << "\");" << endl;
+    stream << "    message << TQT_DBusData::fromStringKeyMap(changed);" << endl;
+    stream << "    message << TQT_DBusData::fromList(TQT_DBusDataList(invalidated));"
+           << endl;
+    stream << endl;
+    stream << "    handleSignalSend(message);" << endl;
+    stream << "}" << endl;
+    stream << endl;
+
+    stream << "void " << classData.name
+           << "::markPropertyChanged(const TQString& name)" << endl;
+    stream << "{" << endl;
+    stream << "    if (m_changedProperties.contains(name)) return;" << endl;
+    stream << endl;
+    stream << "    m_changedProperties.append(name);" << endl;
+    stream << endl;
+    stream << "    // the first change of an event loop turn schedules the emit"
+           << endl;
+    stream << "    if (m_changedProperties.count() > 1) return;" << endl;
+    stream << endl;
+    stream << "    if (m_propertiesTracker == 0)" << endl;
+    stream << "        m_propertiesTracker = new PropertiesTracker(this);" << endl;
+    stream << endl;
+    stream << "    TQApplication::postEvent(m_propertiesTracker, "
+           << "new TQCustomEvent(TQEvent::User));" << endl;
+    stream << "}" << endl;
+    stream << endl;
+
+    stream << "bool " << classData.name
+           << "::handlePropertiesCall(const TQT_DBusMessage& message)" << endl;
+    stream << "{" << endl;
+    stream << "    if (message.count() < 1 || message[0].toString() != \""
+           << classData.dbusName << "\") return false;" << endl;
+    stream << endl;
+    stream << "    TQT_DBusError error;" << endl;
+    stream << "    TQT_DBusMessage reply;" << endl;
+    stream << endl;
+    stream << "    if (message.member() == \"Get\" && message.count() == 2)" << endl;
+    stream << "    {" << endl;
+    stream << "        TQT_DBusVariant variant;" << endl;
+    stream << "        if (getDBusProperty(message[1].toString(), variant, error))" << endl;
+    stream << "        {" << endl;
+    stream << "            reply = TQT_DBusMessage::methodReply(message);" << endl;
+    stream << "            reply << TQT_DBusData::fromVariant(variant);" << endl;
+    stream << "        }" << endl;
+    stream << "    }" << endl;
+    stream << "    else if (message.member() == \"GetAll\" && message.count() == 1)" << endl;
+    stream << "    {" << endl;
+    stream << "        TQT_DBusDataMap<TQString> values;" << endl;
+    stream << "        if (getAllDBusProperties(values, error))" << endl;
+    stream << "        {" << endl;
+    stream << "            reply = TQT_DBusMessage::methodReply(message);" << endl;
+    stream << "            reply << TQT_DBusData::fromStringKeyMap(values);" << endl;
+    stream << "        }" << endl;
+    stream << "    }" << endl;
+    stream << "    else if (message.member() == \"Set\" && message.count() == 3)" << endl;
+    stream << "    {" << endl;
+    stream << "        bool ok = false;" << endl;
+    stream << "        TQT_DBusVariant variant = message[2].toVariant(&ok);" << endl;
+    stream << "        if (!ok)" << endl;
+    stream << "            error = TQT_DBusError::stdInvalidArgs("
+           << "\"Property value is not a variant\");" << endl;
+    stream << "        else if (setDBusProperty(message[1].toString(), variant, error))"
+           << endl;
+    stream << "            reply = TQT_DBusMessage::methodReply(message);" << endl;
+    stream << "    }" << endl;
+    stream << "    else" << endl;
+    stream << "        return false;" << endl;
+    stream << endl;
+    stream << "    if (error.isValid())" << endl;
+    stream << "        reply = TQT_DBusMessage::methodError(message, error);" << endl;
+    stream << endl;
+    stream << "    handleMethodReply(reply);" << endl;
+    stream << endl;
+    stream << "    return true;" << endl;
     stream << "}" << endl;
     stream << endl;
 }
@@ -1281,7 +1689,13 @@ void MethodGenerator::writeProxyMethod(const TQString& className,
     stream << "TQT_DBusError& error)" << endl;
 
     stream << "{" << endl;
-    stream << "    TQValueList<TQT_DBusData> parameters;" << endl;
+    stream << "    TQT_DBusMessage message = m_baseProxy->methodCall(\""
+           << method.name << "\");" << endl;
+    stream << "    if (message.type() == TQT_DBusMessage::InvalidMessage)" << endl;
+    stream << "    {" << endl;
+    stream << "        error = m_baseProxy->lastError();" << endl;
+    stream << "        return false;" << endl;
+    stream << "    }" << endl;
     stream << endl;
 
     uint outCount = 0;
@@ -1297,19 +1711,19 @@ void MethodGenerator::writeProxyMethod(const TQString& className,
 
         if (!(*it).annotatedType.isEmpty())
         {
-            stream << "    TQT_DBusData " << (*it).name << "Data;" << endl;
-
-            // TODO error handling
-            stream << "    if (TQT_DBusDataConverter::convertToTQT_DBusData<"
-                   << (*it).annotatedType << ">(" << (*it).name << ", "
-                   << (*it).name << "Data"
-                   << ") != TQT_DBusDataConverter::Success) return false;"
+            stream << "    if (message.append<" << (*it).annotatedType << ">("
+                   << (*it).name << ") != TQT_DBusDataConverter::Success)"
                    << endl;
-            stream << "    parameters << " << (*it).name << "Data;" << endl;
+            stream << "    {" << endl;
+            stream << "        error = TQT_DBusError::stdInvalidArgs(\""
+                   << "Cannot marshall argument '" << (*it).name << "' of "
+                   << method.name << "\");" << endl;
+            stream << "        return false;" << endl;
+            stream << "    }" << endl;
         }
         else if (!(*it).accessor.isEmpty())
         {
-            stream << "    parameters << TQT_DBusData::from" << (*it).accessor << "(";
+            stream << "    message << TQT_DBusData::from" << (*it).accessor << "(";
 
             if ((*it).subAccessor.isEmpty())
                 stream << (*it).name;
@@ -1319,15 +1733,14 @@ void MethodGenerator::writeProxyMethod(const TQString& className,
             stream << ");" << endl;
         }
         else
-            stream << "    parameters << " << (*it).name << ";" << endl;
+            stream << "    message << " << (*it).name << ";" << endl;
     }
 
     stream << endl;
 
     if (outCount == 0 && method.noReply)
     {
-        stream << "    if (!m_baseProxy->send(\"" << method.name
-               << "\", parameters))" << endl;
+        stream << "    if (!m_baseProxy->send(message))" << endl;
         stream << "    {" << endl;
         stream << "        error = m_baseProxy->lastError();" << endl;
         stream << "        return false;" << endl;
@@ -1340,8 +1753,8 @@ void MethodGenerator::writeProxyMethod(const TQString& className,
 
     if (method.async)
     {
-        stream << "    asyncCallId = m_baseProxy->sendWithAsyncReply(\"";
-        stream << method.name << "\", parameters);" << endl;
+        stream << "    asyncCallId = m_baseProxy->sendWithAsyncReply(message);"
+               << endl;
         stream << endl;
 
         stream << "    if (asyncCallId != 0) m_asyncCalls[asyncCallId] = \""
@@ -1357,8 +1770,8 @@ void MethodGenerator::writeProxyMethod(const TQString& className,
         return;
     }
 
-    stream << "    TQT_DBusMessage reply = m_baseProxy->sendWithReply(\"";
-    stream << method.name << "\", parameters, &error);" << endl;
+    stream << "    TQT_DBusMessage reply = m_baseProxy->sendWithReply(message, &error);"
+           << endl;
     stream << endl;
 
     stream << "    if (reply.type() != TQT_DBusMessage::ReplyMessage) return false;"
@@ -1374,28 +1787,35 @@ void MethodGenerator::writeProxyMethod(const TQString& className,
 
     stream << endl;
 
-    // TODO: create error or use enum for return
-    stream << "    if (reply.count() != " << outCount << ") return false;" << endl;
+    const TQString replyError = TQString("        error = TQT_DBusError::stdInvalidSignature(\""
+                                         "Unexpected reply to %1\");").arg(method.name);
+
+    stream << "    if (reply.count() != " << outCount << ")" << endl;
+    stream << "    {" << endl;
+    stream << replyError << endl;
+    stream << "        return false;" << endl;
+    stream << "    }" << endl;
     stream << endl;
 
     bool firstAccessor    = true;
     bool firstSubAccessor = true;
 
+    uint index = 0;
+
     it = method.arguments.begin();
     for (; it != endIt; ++it)
     {
         if ((*it).direction == Argument::In) continue;
 
-        --outCount;
-
         if (!(*it).annotatedType.isEmpty())
         {
-            // TODO error handling
-            stream << "    if (TQT_DBusDataConverter::convertFromTQT_DBusData<"
-                   << (*it).annotatedType << ">(reply.front(), "
-                   << (*it).name
-                   << ") != TQT_DBusDataConverter::Success) return false;"
-                   << endl;
+            stream << "    if (reply.read<" << (*it).annotatedType << ">("
+                   << index << ", " << (*it).name
+                   << ") != TQT_DBusDataConverter::Success)" << endl;
+            stream << "    {" << endl;
+            stream << replyError << endl;
+            stream << "        return false;" << endl;
+            stream << "    }" << endl;
         }
         else if (!(*it).accessor.isEmpty())
         {
@@ -1408,7 +1828,7 @@ void MethodGenerator::writeProxyMethod(const TQString& className,
 
             if ((*it).subAccessor.isEmpty())
             {
-                stream << "    " << (*it).name << " = reply.front().to"
+                stream << "    " << (*it).name << " = reply[" << index << "].to"
                     << (*it).accessor << "(&ok);" << endl;
             }
             else
@@ -1420,26 +1840,24 @@ void MethodGenerator::writeProxyMethod(const TQString& className,
                     firstSubAccessor = false;
                 }
 
-                stream << "    " << (*it).name << " = reply.front().to"
+                stream << "    " << (*it).name << " = reply[" << index << "].to"
                     << (*it).accessor << "(&ok).to" << (*it).subAccessor
                     << "(&subOK);" << endl;
 
-                // TODO: create error or use enum for return
-                stream << "    if (!subOK) return false;" << endl;
+                stream << "    if (!subOK) ok = false;" << endl;
             }
 
-            // TODO: create error or use enum for return
-            stream << "    if (!ok) return false;" << endl;
+            stream << "    if (!ok)" << endl;
+            stream << "    {" << endl;
+            stream << replyError << endl;
+            stream << "        return false;" << endl;
+            stream << "    }" << endl;
         }
         else
-            stream << "    " << (*it).name << " = reply.front();" << endl;
+            stream << "    " << (*it).name << " = reply[" << index << "];" << endl;
         stream << endl;
 
-        if (outCount > 0)
-        {
-            stream << "    reply.pop_front();" << endl;
-            stream << endl;
-        }
+        ++index;
     }
 
     stream << "    return true;" << endl;
@@ -1471,6 +1889,10 @@ void MethodGenerator::writeProxyGenericProperty(const Class& classData,
     stream << endl;
 
     stream << "    connection.sendWithReply(message, &error);" << endl;
+    stream << endl;
+
+    // the peer might store a different value than the one it has been given
+    stream << "    m_baseProxy->invalidateCachedProperty(name);" << endl;
 
     stream << "}" << endl;
 
@@ -1481,6 +1903,11 @@ void MethodGenerator::writeProxyGenericProperty(const Class& classData,
            << endl;
     stream << "{" << endl;
 
+    stream << "    TQT_DBusVariant cached;" << endl;
+    stream << "    if (m_baseProxy->cachedProperty(name, cached)) return cached;"
+           << endl;
+    stream << endl;
+
     stream << "    TQT_DBusConnection connection = m_baseProxy->connection();" << endl;
     stream << endl;
 
@@ -1511,11 +1938,40 @@ void MethodGenerator::writeProxyGenericProperty(const Class& classData,
     stream << "    if (!ok) return TQT_DBusVariant();" << endl;
     stream << endl;
 
+    stream << "    m_baseProxy->setCachedProperty(name, value);" << endl;
+    stream << endl;
+
     stream << "    return value;" << endl;
 
     stream << "}" << endl;
 
     stream << endl;
+
+    stream << "void " << classData.name
+           << "::setPropertyCacheEnabled(bool enabled)" << endl;
+    stream << "{" << endl;
+    stream << "    m_baseProxy->setPropertyCacheEnabled(enabled);" << endl;
+    stream << "}" << endl;
+    stream << endl;
+
+    stream << "bool " << classData.name << "::isPropertyCacheEnabled() const"
+           << endl;
+    stream << "{" << endl;
+    stream << "    return m_baseProxy->isPropertyCacheEnabled();" << endl;
+    stream << "}" << endl;
+    stream << endl;
+
+    stream << "uint " << classData.name << "::propertyCacheHits() const" << endl;
+    stream << "{" << endl;
+    stream << "    return m_baseProxy->propertyCacheHits();" << endl;
+    stream << "}" << endl;
+    stream << endl;
+
+    stream << "uint " << classData.name << "::propertyCacheMisses() const" << endl;
+    stream << "{" << endl;
+    stream << "    return m_baseProxy->propertyCacheMisses();" << endl;
+    stream << "}" << endl;
+    stream << endl;
 }
 
 void MethodGenerator::writeProxyProperty(const Class& classData,
@@ -1537,10 +1993,16 @@ void MethodGenerator::writeProxyProperty(const Class& classData,
 
         if (!property.annotatedType.isEmpty())
         {
-            // TODO: error handling
-            stream << "    TQT_DBusDataConverter::convertToTQT_DBusData<"
-                   << property.annotatedType << ">(value, variant.value);"
-                   << endl;
+            stream << "    if (TQT_DBusDataConverter::convertToTQT_DBusData<"
+                   << property.annotatedType << ">(value, variant.value) != "
+                   << "TQT_DBusDataConverter::Success)" << endl;
+            stream << "    {" << endl;
+            stream << "        error = TQT_DBusError::stdInvalidArgs("
+                   << "\"Unable to convert value of property '"
+                   << property.name << "' to type '" << property.dbusSignature
+                   << "'\");" << endl;
+            stream << "        return;" << endl;
+            stream << "    }" << endl;
         }
         else if (!property.accessor.isEmpty())
         {
@@ -1584,11 +2046,15 @@ void MethodGenerator::writeProxyProperty(const Class& classData,
         if (!property.annotatedType.isEmpty())
         {
             stream << "    " << property.signature << " result;" << endl;
-
-            // TODO error handling
-            stream << "    TQT_DBusDataConverter::convertFromTQT_DBusData<"
-                   << property.annotatedType << ">(variant.value, result);"
-                   << endl;
+            stream << "    if (TQT_DBusDataConverter::convertFromTQT_DBusData<"
+                   << property.annotatedType << ">(variant.value, result) != "
+                   << "TQT_DBusDataConverter::Success)" << endl;
+            stream << "    {" << endl;
+            stream << "        error = TQT_DBusError::stdInvalidSignature("
+                   << "\"Unable to convert value of property '"
+                   << property.name << "' from type '" << property.dbusSignature
+                   << "'\");" << endl;
+            stream << "    }" << endl;
         }
         else if (!property.accessor.isEmpty())
         {
@@ -1611,12 +2077,16 @@ void MethodGenerator::writeProxyProperty(const Class& classData,
                        << property.accessor << "(&ok).to" << property.subAccessor
                        << "(&subOK);" << endl;
 
-                // TODO: create error
-                stream << "    if (!subOK) {}" << endl;
+                stream << "    if (!subOK) ok = false;" << endl;
             }
 
-            // TODO: create error
-            stream << "    if (!ok) {}" << endl;
+            stream << "    if (!ok)" << endl;
+            stream << "    {" << endl;
+            stream << "        error = TQT_DBusError::stdInvalidSignature("
+                   << "\"Unable to convert value of property '"
+                   << property.name << "' from type '" << property.dbusSignature
+                   << "'\");" << endl;
+            stream << "    }" << endl;
         }
         else
             stream << "    " << property.signature << " result = variant.value;";
@@ -1664,12 +2134,17 @@ void MethodGenerator::writeProxyAsyncReplyHandler(const Class& classData,
 
         stream << "        if (message.type() == TQT_DBusMessage::ErrorMessage) {" << endl;
         stream << "            emit AsyncErrorResponseDetected(_asyncCallId, message.error());" << endl;
+        stream << "            return;" << endl;
         stream << "        }" << endl << endl;
 
         Method signal = *it;
         signal.arguments.pop_front();
 
-        writeVariables("        ", signal, stream);
+        TQStringList failure;
+        failure << "emit AsyncErrorResponseDetected(_asyncCallId, %1);";
+        failure << "return;";
+
+        writeVariables("        ", signal, failure, stream);
         stream << endl;
 
         signal = *it;
@@ -1765,6 +2240,39 @@ void MethodGenerator::writeIntrospectionDataMethod(const Class& classData,
         stream << "    interfaceElement.appendChild(methodElement);" << endl;
     }
 
+    TQValueList<Property>::const_iterator propertyIt    = classData.properties.begin();
+    TQValueList<Property>::const_iterator propertyEndIt = classData.properties.end();
+    for (; propertyIt != propertyEndIt; ++propertyIt)
+    {
+        if (firstMethod)
+        {
+            firstMethod = false;
+            stream << "    TQDomDocument document = interfaceElement.ownerDocument();" << endl;
+            stream << endl;
+            stream << "    TQDomElement methodElement = document.createElement("
+                   << "\"property\");" << endl;
+        }
+        else
+        {
+            stream << endl;
+            stream << "    methodElement = document.createElement("
+                   << "\"property\");" << endl;
+        }
+
+        TQString access;
+        if ((*propertyIt).read)  access += "read";
+        if ((*propertyIt).write) access += "write";
+
+        stream << "    methodElement.setAttribute(\"name\",   \""
+               << (*propertyIt).name << "\");" << endl;
+        stream << "    methodElement.setAttribute(\"type\",   \""
+               << (*propertyIt).dbusSignature << "\");" << endl;
+        stream << "    methodElement.setAttribute(\"access\", \""
+               << access << "\");" << endl;
+
+        stream << "    interfaceElement.appendChild(methodElement);" << endl;
+    }
+
     stream << "}" << endl;
     stream << endl;
 }
@@ -1838,8 +2346,16 @@ void MethodGenerator::writeNodeMethods(const Class& classData,
     stream << "bool " << classData.name
            << "::handleMethodCall(const TQT_DBusMessage& message)" << endl;
     stream << "{" << endl;
+    stream << "    TQString interfaceName = message.interface();" << endl;
+    stream << endl;
+    stream << "    // property access names the interface in the first argument"
+           << endl;
+    stream << "    if (interfaceName == \"org.freedesktop.DBus.Properties\" "
+           << "&& message.count() > 0)" << endl;
+    stream << "        interfaceName = message[0].toString();" << endl;
+    stream << endl;
     stream << "    TQMap<TQString, TQT_DBusObjectBase*>::iterator findIt = "
-           << "m_private->interfaces.find(message.interface());" << endl;
+           << "m_private->interfaces.find(interfaceName);" << endl;
     stream << "    if (findIt == m_private->interfaces.end()) return false;"
            << endl;
     stream << endl;
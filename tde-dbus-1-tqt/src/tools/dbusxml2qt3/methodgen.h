@@ -128,6 +128,9 @@ public:
     static void writeInterfaceMainMethod(const Class& classData,
                                          TQTextStream& stream);
 
+    static void writeInterfaceProperties(const Class& classData,
+                                         TQTextStream& stream);
+
     static void writeSignalHandler(const Class& classData, TQTextStream& stream);
 
     static void writeProxyBegin(const Class& classData, TQTextStream& stream);
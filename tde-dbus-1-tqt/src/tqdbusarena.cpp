@@ -0,0 +1,119 @@
+/* tqdbusarena.cpp allocation arena for de-marshalled data
+ *
+ * Licensed under the Academic Free License version 2.1
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ *
+ */
+
+#include "tqdbusarena_p.h"
+
+#include <stdlib.h>
+
+static const size_t blockSize = 4096;
+static const size_t minFirstBlockSize = 256;
+static const size_t maxFirstBlockSize = 1024 * 1024;
+static const size_t alignment = 8;
+
+// messages can be de-marshalled on worker threads as well
+static __thread TQT_DBusArena* currentArena = 0;
+
+TQT_DBusArena::TQT_DBusArena(size_t sizeHint) : m_blocks(0), m_firstBlockSize(blockSize), m_ref(1)
+{
+    if (sizeHint != 0)
+    {
+        if (sizeHint < minFirstBlockSize)
+            m_firstBlockSize = minFirstBlockSize;
+        else if (sizeHint > maxFirstBlockSize)
+            m_firstBlockSize = maxFirstBlockSize;
+        else
+            m_firstBlockSize = sizeHint;
+    }
+}
+
+TQT_DBusArena::~TQT_DBusArena()
+{
+    while (m_blocks != 0)
+    {
+        Block* block = m_blocks;
+        m_blocks = block->next;
+        free(block);
+    }
+}
+
+void* TQT_DBusArena::allocate(size_t size)
+{
+    size = (size + alignment - 1) & ~(alignment - 1);
+
+    const size_t headerSize = (sizeof(Block) + alignment - 1) & ~(alignment - 1);
+
+    if (m_blocks == 0 || m_blocks->used + size > m_blocks->size)
+    {
+        const size_t defaultSize = (m_blocks == 0) ? m_firstBlockSize : blockSize;
+        const size_t dataSize = size > defaultSize ? size : defaultSize;
+
+        Block* block = (Block*) malloc(headerSize + dataSize);
+        if (block == 0) return 0;
+
+        block->size = dataSize;
+        block->used = 0;
+
+        // oversized blocks go behind the current one so it can still be used
+        if (m_blocks != 0 && dataSize > blockSize)
+        {
+            block->next = m_blocks->next;
+            m_blocks->next = block;
+        }
+        else
+        {
+            block->next = m_blocks;
+            m_blocks = block;
+        }
+
+        block->used = size;
+        return ((char*) block) + headerSize;
+    }
+
+    void* result = ((char*) m_blocks) + headerSize + m_blocks->used;
+    m_blocks->used += size;
+
+    return result;
+}
+
+void TQT_DBusArena::ref()
+{
+    m_ref.ref();
+}
+
+void TQT_DBusArena::deref()
+{
+    if (!m_ref.deref()) delete this;
+}
+
+TQT_DBusArena* TQT_DBusArena::current()
+{
+    return currentArena;
+}
+
+TQT_DBusArena::Scope::Scope(TQT_DBusArena* arena) : m_previous(currentArena)
+{
+    currentArena = arena;
+}
+
+TQT_DBusArena::Scope::~Scope()
+{
+    currentArena = m_previous;
+}
@@ -0,0 +1,94 @@
+/* tqdbusarena_p.h allocation arena for de-marshalled data
+ *
+ * Licensed under the Academic Free License version 2.1
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ *
+ */
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the public API.  This header file may
+// change from version to version without notice, or even be
+// removed.
+//
+// We mean it.
+//
+//
+
+#ifndef TQDBUSARENA_P_H
+#define TQDBUSARENA_P_H
+
+#include <stddef.h>
+
+#include "tqdbusatomic.h"
+
+// Bump allocator for the values de-marshalled from one message.
+//
+// Memory is only released as a whole when the last reference is gone.
+// The message holds one reference and every value allocated from the arena
+// holds another one, so values which outlive their message stay valid.
+// Copies of values made outside of de-marshalling are copied out of the
+// arena, so retaining a value does not keep all of its memory alive.
+class TQT_DBusArena
+{
+public:
+    // sizeHint is the expected total size of the allocations, used for the
+    // first block. 0 uses the default block size
+    TQT_DBusArena(size_t sizeHint = 0);
+
+    void* allocate(size_t size);
+
+    void ref();
+    void deref();
+
+    // arena used by allocations of de-marshalled values, if any
+    static TQT_DBusArena* current();
+
+    // makes an arena current for its life time
+    class Scope
+    {
+    public:
+        Scope(TQT_DBusArena* arena);
+        ~Scope();
+
+    private:
+        TQT_DBusArena* m_previous;
+    };
+
+private:
+    ~TQT_DBusArena();
+
+    // not copyable
+    TQT_DBusArena(const TQT_DBusArena&);
+    TQT_DBusArena& operator=(const TQT_DBusArena&);
+
+private:
+    struct Block
+    {
+        Block* next;
+        size_t size;
+        size_t used;
+    };
+
+    Block* m_blocks;
+    size_t m_firstBlockSize;
+    Atomic m_ref;
+};
+
+#endif
@@ -1,4 +1,4 @@
-/* qdbusatomic.h Dummy reference counter
+/* qdbusatomic.h Thread-safe reference counter
  *
  * Copyright (C) 2005 Kevin Krammer <kevin.krammer@gmx.at>
  *
@@ -24,14 +24,60 @@
 #ifndef ATOMIC_H
 #define ATOMIC_H
 
+// Reference counter which can be changed from several threads at once.
+//
+// This only makes sharing itself thread-safe: copies of a shared object
+// can be created and destroyed on different threads, however the object
+// they refer to must not be modified while other threads can access it.
 class Atomic
 {
 public:
-    Atomic(int value);
+    inline Atomic(int value) : m_value(value) {}
 
-    void ref();
+    inline void ref() { increment(m_value); }
 
-    bool deref();
+    // returns false when the last reference has been released
+    inline bool deref() { return decrement(m_value) != 0; }
+
+    // for counters which are not an Atomic, e.g. TQShared::count
+    static inline unsigned int increment(unsigned int& value)
+    {
+#if defined(__ATOMIC_RELAXED)
+        return __atomic_add_fetch(&value, 1u, __ATOMIC_RELAXED);
+#else
+        return __sync_add_and_fetch(&value, 1u);
+#endif
+    }
+
+    static inline unsigned int decrement(unsigned int& value)
+    {
+        // acquire/release so the last owner sees all changes of the others
+        // before it deletes the object
+#if defined(__ATOMIC_ACQ_REL)
+        return __atomic_sub_fetch(&value, 1u, __ATOMIC_ACQ_REL);
+#else
+        return __sync_sub_and_fetch(&value, 1u);
+#endif
+    }
+
+private:
+    static inline int increment(int& value)
+    {
+#if defined(__ATOMIC_RELAXED)
+        return __atomic_add_fetch(&value, 1, __ATOMIC_RELAXED);
+#else
+        return __sync_add_and_fetch(&value, 1);
+#endif
+    }
+
+    static inline int decrement(int& value)
+    {
+#if defined(__ATOMIC_ACQ_REL)
+        return __atomic_sub_fetch(&value, 1, __ATOMIC_ACQ_REL);
+#else
+        return __sync_sub_and_fetch(&value, 1);
+#endif
+    }
 
 private:
     int m_value;
@@ -28,6 +28,7 @@
 #include "tqdbuserror.h"
 #include "tqdbusmessage.h"
 #include "tqdbusconnection_p.h"
+#include "tqdbusiothread_p.h"
 
 #include "tqdbusmessage_p.h"
 
@@ -199,6 +200,10 @@ TQT_DBusConnection TQT_DBusConnection::addConnection(BusType type, const TQStrin
     if (d)
         return TQT_DBusConnection(name);
 
+    // libdbus only makes connections opened after this thread safe, so it
+    // has to be done before the I/O thread or the worker pool may be enabled
+    dbus_threads_init_default();
+
     d = new TQT_DBusConnectionPrivate;
     DBusConnection *c = 0;
     switch (type) {
@@ -229,6 +234,9 @@ TQT_DBusConnection TQT_DBusConnection::addConnection(const TQString &address,
     if (d)
         return TQT_DBusConnection(name);
 
+    // see above
+    dbus_threads_init_default();
+
     d = new TQT_DBusConnectionPrivate;
     // setConnection does the error handling for us
     d->setConnection(dbus_connection_open(address.utf8().data(), &d->error));
@@ -245,7 +253,17 @@ void TQT_DBusConnection::closeConnection(const TQString &name)
 
 void TQT_DBusConnectionPrivate::timerEvent(TQTimerEvent *e)
 {
-    DBusTimeout *timeout = timeouts[e->timerId()];
+    timeoutMutex.lock();
+    TimeoutHash::const_iterator it = timeouts.find(e->timerId());
+    DBusTimeout *timeout = (it != timeouts.end()) ? it.data() : 0;
+    timeoutMutex.unlock();
+
+    // the timeout has been removed by the I/O thread
+    if (timeout == 0) {
+        killTimer(e->timerId());
+        return;
+    }
+
     dbus_timeout_handle(timeout);
 }
 
@@ -258,7 +276,7 @@ bool TQT_DBusConnection::send(const TQT_DBusMessage &message) const
     if (!msg)
         return false;
 
-    bool isOk = dbus_connection_send(d->connection, msg, 0);
+    bool isOk = d->sendFromAnyThread(msg);
     dbus_message_unref(msg);
     return isOk;
 }
@@ -281,10 +299,23 @@ TQT_DBusMessage TQT_DBusConnection::sendWithReply(const TQT_DBusMessage &message
     if (!msg)
         return TQT_DBusMessage::fromDBusMessage(0);
 
-    DBusMessage *reply = dbus_connection_send_with_reply_and_block(d->connection, msg, -1, &d->error);
+    DBusMessage *reply = 0;
+    if (d->canProcessEventsDuringCall())
+        reply = d->sendWithReplyAndProcessEvents(msg, d->callTimeout(message));
+    else
+    {
+        TQT_DBusBlockingCall blocking(d->ioThread);
+        reply = dbus_connection_send_with_reply_and_block(d->connection, msg,
+                                                          d->callTimeout(message),
+                                                          &d->error);
+    }
 
-    if (d->handleError() && error)
-        *error = d->lastError;
+    if (d->handleError())
+    {
+        d->checkTimedOut(d->lastError);
+        if (error)
+            *error = d->lastError;
+    }
 
     dbus_message_unref(msg);
 
@@ -326,9 +357,17 @@ bool TQT_DBusConnection::connect(TQObject* object, const char* slot)
     if (!d || !d->connection || !object || !slot)
         return false;
 
-    bool ok = object->connect(d, TQ_SIGNAL(dbusSignal(const TQT_DBusMessage&)), slot);
+    return d->connectAllSignals(object, slot);
+}
+
+bool TQT_DBusConnection::connect(TQObject* object, const char* slot,
+                                 const TQString& sender, const TQString& path,
+                                 const TQString& interface, const TQString& member)
+{
+    if (!d || !d->connection || !object || !slot)
+        return false;
 
-    return ok;
+    return d->connectSignal(object, slot, sender, path, interface, member);
 }
 
 bool TQT_DBusConnection::disconnect(TQObject* object, const char* slot)
@@ -336,9 +375,121 @@ bool TQT_DBusConnection::disconnect(TQObject* object, const char* slot)
     if (!d || !d->connection || !object || !slot)
         return false;
 
-    bool ok = d->disconnect(object, slot);
+    return d->disconnectAllSignals(object, slot);
+}
+
+bool TQT_DBusConnection::disconnect(TQObject* object, const char* slot,
+                                    const TQString& sender, const TQString& path,
+                                    const TQString& interface, const TQString& member)
+{
+    if (!d || !d->connection || !object || !slot)
+        return false;
+
+    return d->disconnectSignal(object, slot, sender, path, interface, member);
+}
+
+bool TQT_DBusConnection::connectBatch(TQObject* object, const char* slot)
+{
+    if (!d || !d->connection || !object || !slot)
+        return false;
+
+    return d->connectSignalBatch(object, slot, TQString::null, TQString::null,
+                                 TQString::null, TQString::null);
+}
+
+bool TQT_DBusConnection::connectBatch(TQObject* object, const char* slot,
+                                      const TQString& sender, const TQString& path,
+                                      const TQString& interface, const TQString& member)
+{
+    if (!d || !d->connection || !object || !slot)
+        return false;
+
+    return d->connectSignalBatch(object, slot, sender, path, interface, member);
+}
+
+bool TQT_DBusConnection::disconnectBatch(TQObject* object, const char* slot)
+{
+    if (!d || !d->connection || !object || !slot)
+        return false;
+
+    return d->disconnectSignalBatch(object, slot, TQString::null, TQString::null,
+                                    TQString::null, TQString::null);
+}
 
-    return ok;
+bool TQT_DBusConnection::disconnectBatch(TQObject* object, const char* slot,
+                                         const TQString& sender, const TQString& path,
+                                         const TQString& interface, const TQString& member)
+{
+    if (!d || !d->connection || !object || !slot)
+        return false;
+
+    return d->disconnectSignalBatch(object, slot, sender, path, interface, member);
+}
+
+void TQT_DBusConnection::setCoalescePropertiesChanged(bool enabled)
+{
+    if (!d) return;
+
+    d->coalescePropertiesChanged = enabled;
+}
+
+bool TQT_DBusConnection::coalescePropertiesChanged() const
+{
+    return d && d->coalescePropertiesChanged;
+}
+
+void TQT_DBusConnection::setDefaultTimeout(int ms)
+{
+    if (!d) return;
+
+    d->defaultTimeout = ms < 0 ? TQT_DBusMessage::DefaultTimeout : ms;
+}
+
+int TQT_DBusConnection::defaultTimeout() const
+{
+    return d ? d->defaultTimeout : TQT_DBusMessage::DefaultTimeout;
+}
+
+void TQT_DBusConnection::setProcessEventsDuringCalls(bool enabled)
+{
+    if (!d) return;
+
+    d->processEventsDuringCalls = enabled;
+}
+
+bool TQT_DBusConnection::processEventsDuringCalls() const
+{
+    return d && d->processEventsDuringCalls;
+}
+
+bool TQT_DBusConnection::setIOThreadEnabled(bool enabled)
+{
+    if (!d) return false;
+
+    if (!enabled)
+    {
+        d->stopIOThread();
+        return true;
+    }
+
+    return d->startIOThread();
+}
+
+bool TQT_DBusConnection::isIOThreadEnabled() const
+{
+    return d && d->ioThread != 0;
+}
+
+uint TQT_DBusConnection::timedOutCalls() const
+{
+    return d ? d->timedOutCalls : 0;
+}
+
+void TQT_DBusConnection::resetTimedOutCalls()
+{
+    if (!d) return;
+
+    d->timedOutCalls = 0;
 }
 
 bool TQT_DBusConnection::registerObject(const TQString& path, TQT_DBusObjectBase* object)
@@ -346,25 +497,51 @@ bool TQT_DBusConnection::registerObject(const TQString& path, TQT_DBusObjectBase
     if (!d || !d->connection || !object || path.isEmpty())
         return false;
 
-    TQT_DBusConnectionPrivate::ObjectMap::const_iterator it = d->registeredObjects.find(path);
-    if (it != d->registeredObjects.end())
+    return d->registerObject(d->registeredObjects, path, object);
+}
+
+void TQT_DBusConnection::unregisterObject(const TQString &path)
+{
+    if (!d || !d->connection || path.isEmpty())
+        return;
+
+    TQT_DBusObjectBase* object = d->registeredObjects.take(path);
+
+    // running method calls might still use the object
+    d->releaseObject(object);
+}
+
+bool TQT_DBusConnection::registerObjectTree(const TQString& path, TQT_DBusObjectBase* object)
+{
+    if (!d || !d->connection || !object || path.isEmpty())
         return false;
 
-    d->registeredObjects.insert(path, object);
+    // the subtree lookup walks up the path without trailing slashes
+    TQString prefix = path;
+    while (prefix.length() > 1 && prefix.endsWith("/"))
+        prefix.truncate(prefix.length() - 1);
 
-    return true;
+    return d->registerObject(d->registeredTrees, prefix, object);
 }
 
-void TQT_DBusConnection::unregisterObject(const TQString &path)
+void TQT_DBusConnection::unregisterObjectTree(const TQString &path)
 {
     if (!d || !d->connection || path.isEmpty())
         return;
 
-    TQT_DBusConnectionPrivate::ObjectMap::iterator it = d->registeredObjects.find(path);
-    if (it == d->registeredObjects.end())
-        return ;
+    TQString prefix = path;
+    while (prefix.length() > 1 && prefix.endsWith("/"))
+        prefix.truncate(prefix.length() - 1);
+
+    d->releaseObject(d->registeredTrees.take(prefix));
+}
+
+bool TQT_DBusConnection::setObjectConcurrency(TQT_DBusObjectBase* object, uint maxCalls)
+{
+    if (!d || !d->connection || !object)
+        return false;
 
-    d->registeredObjects.erase(it);
+    return d->setObjectConcurrency(object, maxCalls);
 }
 
 bool TQT_DBusConnection::isConnected( ) const
@@ -400,7 +577,10 @@ bool TQT_DBusConnection::requestName(const TQString &name, int modeFlags)
     if (modeFlags & ReplaceExisting)
         dbusFlags |= DBUS_NAME_FLAG_REPLACE_EXISTING;
 
-    dbus_bus_request_name(d->connection, name.utf8(), dbusFlags, &d->error);
+    {
+        TQT_DBusBlockingCall blocking(d->ioThread);
+        dbus_bus_request_name(d->connection, name.utf8(), dbusFlags, &d->error);
+    }
     bool res = !d->handleError();
     res &= d->handleUnreadMessages();
     return res;
@@ -128,6 +128,8 @@ class TQT_DBusMessage;
 class TQT_DBusObjectBase;
 class TQObject;
 
+template <typename T> class TQValueList;
+
 /**
  * @brief Provides access to a specific D-Bus bus
  *
@@ -458,6 +460,12 @@ public:
      *
      * This provides a basic access to all D-Bus signals received on this
      * connection.
+     *
+     * @note this asks the bus to deliver @em all signals to this
+     *       application, which can be quite expensive on a busy bus.
+     *       Prefer connect(TQObject*, const char*, const TQString&,
+     *       const TQString&, const TQString&, const TQString&) which only
+     *       subscribes to the signals the receiver is interested in
      * For every D-Bus signal processed by the connection object a TQt signal
      * is emitted and thus delivered to all receiver objects connected
      * through this method.
@@ -498,6 +506,43 @@ public:
      */
     bool connect(TQObject* object, const char* slot);
 
+    /**
+     * @brief Connects an object to receive a subset of D-Bus signals
+     *
+     * Like connect(TQObject*, const char*) but additionally registers a
+     * match rule with the bus so only signals matching the given @p sender,
+     * @p path, @p interface and @p member are delivered to the application.
+     * Empty values act as wildcards.
+     *
+     * Identical match rules of several receivers are shared, the bus is only
+     * contacted when the first receiver for a rule connects or the last one
+     * disconnects.
+     *
+     * Received signals are routed through an index on these values, so
+     * the receiver only gets signals matching its path, interface and
+     * member, independent of the number of other receivers.
+     *
+     * @note signals always carry the unique name of their sender, so the
+     *       @p sender is only checked locally if it is a unique name, i.e.
+     *       starts with a colon. For well-known names the receiver relies
+     *       on the bus' evaluation of the match rule
+     *
+     * @param object the receiver object
+     * @param slot the receiver slot (or signal for signal->signal connections)
+     * @param sender the service name of the signal emitter
+     * @param path the object path of the signal emitter
+     * @param interface the interface the signal belongs to
+     * @param member the name of the signal
+     *
+     * @return @c true if the connection was successfull, otherwise @c false
+     *
+     * @see disconnect(TQObject*, const char*, const TQString&, const TQString&,
+     *                 const TQString&, const TQString&)
+     */
+    bool connect(TQObject* object, const char* slot,
+                 const TQString& sender, const TQString& path,
+                 const TQString& interface, const TQString& member = TQString::null);
+
     /**
      * @brief Disconnects a given receiver from the D-Bus signal handling
      *
@@ -510,6 +555,265 @@ public:
      */
     bool disconnect(TQObject* object, const char* slot);
 
+    /**
+     * @brief Disconnects a receiver connected for a subset of D-Bus signals
+     *
+     * Has to be called with the same match values as the respective
+     * connect() call so the match rule can be released.
+     *
+     * @param object the receiver object to disconnect from
+     * @param slot the receiver slot (or signal for signal->signal connections)
+     * @param sender the service name used when connecting
+     * @param path the object path used when connecting
+     * @param interface the interface used when connecting
+     * @param member the signal name used when connecting
+     *
+     * @return @c true if the disconnect was successfull, otherwise @c false
+     *
+     * @see connect(TQObject*, const char*, const TQString&, const TQString&,
+     *              const TQString&, const TQString&)
+     */
+    bool disconnect(TQObject* object, const char* slot,
+                    const TQString& sender, const TQString& path,
+                    const TQString& interface, const TQString& member = TQString::null);
+
+    /**
+     * @brief Connects an object to receive D-Bus signals in batches
+     *
+     * Instead of one slot invocation per D-Bus signal, the receiver gets all
+     * signals processed during one event loop iteration as one list,
+     * after they have been delivered through connect().
+     *
+     * The required slot signature is
+     * @code
+     *   void slotname(const TQValueList<TQT_DBusMessage>&);
+     * @endcode
+     *
+     * Like connect(TQObject*, const char*) this subscribes to all signals on
+     * the bus. Receivers only interested in some of them should use the
+     * overload taking a filter instead.
+     *
+     * @param object the receiver object
+     * @param slot the receiver slot (or signal for signal->signal connections)
+     *
+     * @return @c true if the connection was successfull, otherwise @c false
+     *
+     * @see disconnectBatch()
+     * @see setCoalescePropertiesChanged()
+     */
+    bool connectBatch(TQObject* object, const char* slot);
+
+    /**
+     * @brief Connects an object to receive a subset of D-Bus signals in batches
+     *
+     * Like connectBatch(TQObject*, const char*) but registers a match rule
+     * for the given @p sender, @p path, @p interface and @p member with the
+     * bus, same as connect(TQObject*, const char*, const TQString&,
+     * const TQString&, const TQString&, const TQString&) does. Each batch
+     * only contains the signals matching these values.
+     *
+     * @param object the receiver object
+     * @param slot the receiver slot (or signal for signal->signal connections)
+     * @param sender the service name of the signal emitter
+     * @param path the object path of the signal emitter
+     * @param interface the interface the signal belongs to
+     * @param member the name of the signal
+     *
+     * @return @c true if the connection was successfull, otherwise @c false
+     *
+     * @see disconnectBatch(TQObject*, const char*, const TQString&,
+     *                      const TQString&, const TQString&, const TQString&)
+     */
+    bool connectBatch(TQObject* object, const char* slot,
+                      const TQString& sender, const TQString& path,
+                      const TQString& interface, const TQString& member = TQString::null);
+
+    /**
+     * @brief Disconnects a given batch receiver from the D-Bus signal handling
+     *
+     * @param object the receiver object to disconnect from
+     * @param slot the receiver slot (or signal for signal->signal connections)
+     *
+     * @return @c true if the disconnect was successfull, otherwise @c false
+     *
+     * @see connectBatch()
+     */
+    bool disconnectBatch(TQObject* object, const char* slot);
+
+    /**
+     * @brief Disconnects a batch receiver connected for a subset of D-Bus signals
+     *
+     * The values have to be the same as the ones passed to connectBatch().
+     *
+     * @param object the receiver object to disconnect from
+     * @param slot the receiver slot (or signal for signal->signal connections)
+     * @param sender the service name of the signal emitter
+     * @param path the object path of the signal emitter
+     * @param interface the interface the signal belongs to
+     * @param member the name of the signal
+     *
+     * @return @c true if the disconnect was successfull, otherwise @c false
+     *
+     * @see connectBatch(TQObject*, const char*, const TQString&, const TQString&,
+     *                   const TQString&, const TQString&)
+     */
+    bool disconnectBatch(TQObject* object, const char* slot,
+                         const TQString& sender, const TQString& path,
+                         const TQString& interface, const TQString& member = TQString::null);
+
+    /**
+     * @brief Sets whether property change signals are merged before delivery
+     *
+     * When enabled, @c org.freedesktop.DBus.Properties.PropertiesChanged
+     * signals received during one event loop iteration from the same sender
+     * and object path for the same interface are merged into the last one
+     * of them: changed values and invalidated properties of later signals
+     * replace earlier ones, and the earlier signals are dropped. The merged
+     * signal is therefore never delivered ahead of other signals its sender
+     * emitted before it.
+     *
+     * This considerably reduces the work during bursts of property changes
+     * but receivers will no longer see intermediate values.
+     *
+     * Disabled by default.
+     *
+     * @param enabled whether to merge the signals
+     *
+     * @see coalescePropertiesChanged()
+     */
+    void setCoalescePropertiesChanged(bool enabled);
+
+    /**
+     * @brief Returns whether property change signals are merged before delivery
+     *
+     * @return @c true if merging is enabled, otherwise @c false
+     *
+     * @see setCoalescePropertiesChanged()
+     */
+    bool coalescePropertiesChanged() const;
+
+    /**
+     * @brief Sets the timeout for method calls which do not specify one
+     *
+     * Calls sent through sendWithReply() or sendWithAsyncReply() whose
+     * message has TQT_DBusMessage::DefaultTimeout wait at most @p ms
+     * milliseconds for their reply. A synchronous call returns with a
+     * TQT_DBusError::NoReply error when the time is up, an asynchronous one
+     * delivers such an error as its reply.
+     *
+     * Initially the D-Bus library's default of about 25 seconds is used.
+     *
+     * @param ms timeout in milliseconds, TQT_DBusMessage::NoTimeout to wait
+     *           as long as necessary or a negative value to go back to the
+     *           D-Bus library's default
+     *
+     * @see defaultTimeout()
+     * @see TQT_DBusMessage::setTimeout()
+     * @see TQT_DBusProxy::setTimeout()
+     */
+    void setDefaultTimeout(int ms);
+
+    /**
+     * @brief Returns the timeout for method calls which do not specify one
+     *
+     * @return the timeout in milliseconds or TQT_DBusMessage::DefaultTimeout
+     *         if the D-Bus library's default is used
+     *
+     * @see setDefaultTimeout()
+     */
+    int defaultTimeout() const;
+
+    /**
+     * @brief Sets whether synchronous calls keep the event loop running
+     *
+     * By default sendWithReply() blocks inside the D-Bus library until the
+     * reply arrives, which also stops timers, socket notifiers, other
+     * connections and repainting of the application.
+     *
+     * If enabled, sendWithReply() instead sends the call and processes
+     * events, excluding user input, until the reply or the call's timeout
+     * arrives. Inbound signals and replies to asynchronous calls can
+     * therefore be delivered while sendWithReply() has not returned yet.
+     *
+     * @note calls made while the connection is handling a method call for a
+     *       registered object (see TQT_DBusObjectBase) or without a
+     *       TQApplication still block, since the reply could not be
+     *       dispatched in that situation
+     *
+     * @param enabled @c true to process events while waiting for replies,
+     *                @c false to block
+     *
+     * @see processEventsDuringCalls()
+     * @see setDefaultTimeout()
+     */
+    void setProcessEventsDuringCalls(bool enabled);
+
+    /**
+     * @brief Returns whether synchronous calls keep the event loop running
+     *
+     * @return @c true if sendWithReply() processes events while waiting,
+     *         otherwise @c false
+     *
+     * @see setProcessEventsDuringCalls()
+     */
+    bool processEventsDuringCalls() const;
+
+    /**
+     * @brief Sets whether the connection does its socket I/O on a thread
+     *
+     * By default reading, parsing and writing messages happens on the GUI
+     * thread, driven by socket notifiers. If enabled, a background thread
+     * does this instead and only hands complete messages to the GUI thread,
+     * where they are dispatched and delivered as before.
+     *
+     * This reduces the time the GUI thread spends on connections with heavy
+     * signal or reply traffic. All TQt signals and slot invocations of the
+     * bindings still happen on the GUI thread.
+     *
+     * @note requires a TQApplication and a client connection, e.g. one
+     *       returned by sessionBus() or systemBus()
+     *
+     * @param enabled @c true to start the I/O thread, @c false to stop it
+     *                and go back to socket notifiers
+     *
+     * @return @c true if the requested mode is now active, @c false if the
+     *         thread could not be started
+     *
+     * @see isIOThreadEnabled()
+     */
+    bool setIOThreadEnabled(bool enabled);
+
+    /**
+     * @brief Returns whether the connection does its socket I/O on a thread
+     *
+     * @return @c true if the I/O thread is running, otherwise @c false
+     *
+     * @see setIOThreadEnabled()
+     */
+    bool isIOThreadEnabled() const;
+
+    /**
+     * @brief Returns the number of method calls which did not get a reply
+     *        in time
+     *
+     * Counts synchronous and asynchronous calls sent on this connection
+     * which failed with a TQT_DBusError::NoReply or TQT_DBusError::Timeout
+     * error.
+     *
+     * @return the number of timed out calls since the connection has been
+     *         established or since the last resetTimedOutCalls()
+     *
+     * @see setDefaultTimeout()
+     */
+    uint timedOutCalls() const;
+
+    /**
+     * @brief Resets the counter of timed out method calls
+     *
+     * @see timedOutCalls()
+     */
+    void resetTimedOutCalls();
+
     /**
      * @brief Registers a service object for a given path
      *
@@ -552,6 +856,77 @@ public:
      */
     void unregisterObject(const TQString &path);
 
+    /**
+     * @brief Registers a service object for a whole object path subtree
+     *
+     * The object will receive method calls for @p path and for all object
+     * paths below it, unless there is a more specific object registered
+     * through registerObject() or another subtree object registered for a
+     * longer prefix. The object can use TQT_DBusMessage::path() to find out
+     * which sub object a call is for.
+     *
+     * This allows services exporting large numbers of objects, e.g. one per
+     * file or device, to serve them from a single implementation object
+     * instead of registering each of them.
+     *
+     * @param path the object path of the subtree's root
+     * @param object the service implementation object for the subtree
+     *
+     * @return @c true if the given object is now registered for the given
+     *         subtree or @c false if path is empty, object is null or another
+     *         object is already registered for this subtree
+     *
+     * @see unregisterObjectTree()
+     * @see registerObject()
+     */
+    bool registerObjectTree(const TQString& path, TQT_DBusObjectBase* object);
+
+    /**
+     * @brief Unregister a service object on a given object path subtree
+     *
+     * Removes any mapping of object path subtree to service object
+     * previously registered by registerObjectTree().
+     *
+     * @warning always(!) unregister a service object before deleting it
+     *
+     * @param path the object path of the subtree's root
+     *
+     * @see registerObjectTree()
+     */
+    void unregisterObjectTree(const TQString &path);
+
+    /**
+     * @brief Sets how many method calls of a service object may run at once
+     *
+     * By default TQT_DBusObjectBase::handleMethodCall() is called on the GUI
+     * thread while the connection dispatches the call, so one slow method
+     * delays all other clients.
+     *
+     * With a limit of at least @c 1, calls for @p object are instead
+     * de-marshalled and handled on a pool of worker threads shared by all
+     * objects of this connection, with at most @p maxCalls of them running
+     * at the same time. Calls from the same sender are handled one after
+     * the other in the order they were received.
+     *
+     * The object's handleMethodCall() then has to be thread-safe. It can
+     * send replies and signals through send(), however it must not use the
+     * blocking sendWithReply() or any TQt GUI class.
+     *
+     * Unregistering the object, e.g. with unregisterObject(), waits until
+     * the calls already accepted for it have been handled.
+     *
+     * @param object the service object, usually already registered
+     * @param maxCalls maximum number of concurrently running calls or @c 0
+     *                 to handle the object's calls on the GUI thread again
+     *
+     * @return @c true if the setting has been applied, @c false if the
+     *         connection is not connected or the worker threads could not
+     *         be set up
+     *
+     * @see registerObject()
+     */
+    bool setObjectConcurrency(TQT_DBusObjectBase* object, uint maxCalls);
+
     /**
      * @brief Gets a connection to the session bus
      *
@@ -37,9 +37,13 @@
 #ifndef TQDBUSCONNECTION_P_H
 #define TQDBUSCONNECTION_P_H
 
+#include <tqdict.h>
+#include <tqevent.h>
 #include <tqguardedptr.h>
 #include <tqmap.h>
+#include <tqmutex.h>
 #include <tqobject.h>
+#include <tqthread.h>
 #include <tqvaluelist.h>
 
 #include <dbus/dbus.h>
@@ -48,6 +52,7 @@
 #include "tqdbuserror.h"
 #include "tqdbusobject.h"
 #include "tqdbusmessage.h"
+#include "tqdbusstringtable_p.h"
 
 class TQT_DBusMessage;
 class TQSocketNotifier;
@@ -61,11 +66,74 @@ class TQT_DBusResultInfo
 {
 	public:
 		TQT_DBusMessage message;
-		TQObject* receiver;
-		TQCString method;
+		TQGuardedPtr<TQObject> receiver;
+		int memberIndex;
+		bool memberIsSignal;
 };
 typedef TQValueList<TQT_DBusResultInfo> TQT_DBusResultInfoList;
 
+// relays D-Bus signals to all receivers sharing the same routing key
+class TQT_DBusSignalHook: public TQObject
+{
+    TQ_OBJECT
+
+public:
+    TQT_DBusSignalHook(int pattern) : TQObject(0), pattern(pattern), users(0) {}
+
+    void emitSignal(const TQT_DBusMessage& message) { emit dbusSignal(message); }
+
+signals:
+    void dbusSignal(const TQT_DBusMessage& message);
+
+public:
+    int pattern;
+    int users;
+};
+
+// relays the D-Bus signals of one event loop iteration matching a filter
+// to all batch receivers sharing it. Empty fields are wildcards
+class TQT_DBusSignalBatchHook: public TQObject
+{
+    TQ_OBJECT
+
+public:
+    TQT_DBusSignalBatchHook(const TQString& sender, const TQString& path,
+                            const TQString& interface, const TQString& member)
+        : TQObject(0), sender(sender), path(path), interface(interface), member(member),
+          users(0) {}
+
+    bool isCatchAll() const
+    {
+        return sender.isEmpty() && path.isEmpty() && interface.isEmpty() && member.isEmpty();
+    }
+
+    bool matches(const TQT_DBusMessage& message) const
+    {
+        return (sender.isEmpty()    || sender    == message.sender())    &&
+               (path.isEmpty()      || path      == message.path())      &&
+               (interface.isEmpty() || interface == message.interface()) &&
+               (member.isEmpty()    || member    == message.member());
+    }
+
+    void emitSignalBatch(const TQValueList<TQT_DBusMessage>& messages)
+    {
+        emit dbusSignalBatch(messages);
+    }
+
+signals:
+    void dbusSignalBatch(const TQValueList<TQT_DBusMessage>& messages);
+
+public:
+    TQString sender;
+    TQString path;
+    TQString interface;
+    TQString member;
+    int users;
+};
+
+class TQT_DBusIOThread;
+class TQT_DBusWorkerPool;
+
 class TQT_DBusConnectionPrivate: public TQObject
 {
     TQ_OBJECT
@@ -81,19 +149,55 @@ public:
     void setServer(DBusServer *server);
     void closeConnection();
     void timerEvent(TQTimerEvent *e);
+    void customEvent(TQCustomEvent *e);
+
+    bool startIOThread();
+    void stopIOThread();
+
+    // can be used by any thread, e.g. by service objects running their
+    // method calls on the worker pool
+    bool sendFromAnyThread(DBusMessage* message);
+
+    static bool callObject(TQT_DBusObjectBase* object, const TQT_DBusMessage& message);
+
+    bool setObjectConcurrency(TQT_DBusObjectBase* object, uint maxCalls);
+    // to be called after the object has been unregistered from a path,
+    // waits for its running calls and removes it from the worker pool
+    // unless it is still registered with another path
+    void releaseObject(TQT_DBusObjectBase* object);
 
     bool handleSignal(DBusMessage *msg);
     bool handleObjectCall(DBusMessage *message);
     bool handleError();
     bool handleUnreadMessages();
 
-    void emitPendingCallReply(const TQT_DBusMessage& message);
+    static TQString catchAllMatchRule();
+    static TQString matchRule(const TQString& sender, const TQString& path,
+                              const TQString& interface, const TQString& member);
+    void addMatchRule(const TQString& rule);
+    void removeMatchRule(const TQString& rule);
+
+    bool connectAllSignals(TQObject* receiver, const char* slot);
+    bool disconnectAllSignals(TQObject* receiver, const char* slot);
+    bool connectSignalBatch(TQObject* receiver, const char* slot,
+                            const TQString& sender, const TQString& path,
+                            const TQString& interface, const TQString& member);
+    bool disconnectSignalBatch(TQObject* receiver, const char* slot,
+                               const TQString& sender, const TQString& path,
+                               const TQString& interface, const TQString& member);
+    bool connectSignal(TQObject* receiver, const char* slot,
+                       const TQString& sender, const TQString& path,
+                       const TQString& interface, const TQString& member);
+    bool disconnectSignal(TQObject* receiver, const char* slot,
+                          const TQString& sender, const TQString& path,
+                          const TQString& interface, const TQString& member);
+    void routeSignal(const TQT_DBusMessage& message);
+
+    void coalescePendingMessages();
 
 signals:
     void dbusSignal(const TQT_DBusMessage& message);
 
-    void dbusPendingCallReply(const TQT_DBusMessage& message);
-
 public slots:
     void socketRead(int);
     void socketWrite(int);
@@ -141,23 +245,121 @@ public:
     // FIXME typedef TQHash<int, DBusTimeout *> TimeoutHash;
     typedef TQMap<int, DBusTimeout*> TimeoutHash;
     TimeoutHash timeouts;
+    // libdbus removes the timeout of a pending call when its reply is read,
+    // which happens on the I/O thread if there is one
+    TQMutex timeoutMutex;
 
-    typedef TQMap<TQString, TQT_DBusObjectBase*> ObjectMap;
+    // does the socket I/O if enabled, see startIOThread()
+    TQT_DBusIOThread* ioThread;
+    TQt::HANDLE mainThread;
+
+    // runs method calls of objects with a concurrency set, created on demand
+    TQT_DBusWorkerPool* workerPool;
+
+    // messages sent by other threads, sent by the GUI thread on SendEvent
+    enum { SendEvent = TQEvent::User + 0x4443 };
+    TQValueList<DBusMessage*> outgoingMessages;
+    TQMutex outgoingMutex;
+
+    // objects registered for exact paths and for whole subtrees
+    typedef TQDict<TQT_DBusObjectBase> ObjectMap;
     ObjectMap registeredObjects;
+    ObjectMap registeredTrees;
+
+    bool registerObject(ObjectMap& map, const TQString& path, TQT_DBusObjectBase* object);
+    TQT_DBusObjectBase* findObject(const TQString& path) const;
+
+    // path, interface, member and sender of the signals and method calls
+    // dispatched on the GUI thread
+    TQT_DBusStringTable headerStrings;
 
     TQValueList<DBusTimeout *> pendingTimeouts;
 
+    // match rules registered with the bus and the number of their users
+    typedef TQMap<TQString, int> MatchRuleMap;
+    MatchRuleMap matchRules;
+
+    // signal routing index. Hooks are keyed on sender, path, interface and
+    // member where empty values are wildcards. hookPatterns counts the hooks
+    // per combination of non-wildcard fields so routing a signal only needs
+    // to look up the combinations actually in use
+    enum HookField { HookSender = 1, HookPath = 2, HookInterface = 4, HookMember = 8 };
+    static TQString hookKey(const TQString& sender, const TQString& path,
+                            const TQString& interface, const TQString& member);
+    TQDict<TQT_DBusSignalHook> signalHooks;
+    int hookPatterns[16];
+
+    // batch receivers, keyed like signalHooks
+    TQDict<TQT_DBusSignalBatchHook> batchHooks;
+
+    struct SignalConnection
+    {
+        TQString hook; // key in signalHooks, empty for catch-all receivers
+        TQString rule; // match rule registered for the connection
+        TQCString slot; // normalized, TQt disconnects all equal connections at once
+        bool batch;    // hook is a key in batchHooks instead
+    };
+    typedef TQValueList<SignalConnection> SignalConnectionList;
+
     struct TQT_DBusPendingCall
     {
-        TQGuardedPtr<TQObject> receiver;
-        TQCString method;
+        // not guarded, objectDestroyed() cancels the calls of a receiver
+        TQObject* receiver;
+        // meta object index of the receiver's slot or signal, see sendWithReplyAsync()
+        int memberIndex;
+        bool memberIsSignal;
         DBusPendingCall *pending;
+
+        // links in the receiver's list of outstanding calls
+        TQT_DBusPendingCall* prev;
+        TQT_DBusPendingCall* next;
     };
     typedef TQMap<DBusPendingCall*, TQT_DBusPendingCall*> PendingCallMap;
     PendingCallMap pendingCalls;
 
+    // objects connected to signals or waiting for replies. Each of them has
+    // its destroyed() signal connected exactly once, so their signal
+    // connections and outstanding calls can be released without looking at
+    // the ones of any other receiver
+    struct TrackedReceiver
+    {
+        TrackedReceiver() : firstPendingCall(0) {}
+
+        SignalConnectionList signalConnections;
+        TQT_DBusPendingCall* firstPendingCall;
+    };
+    typedef TQMap<TQObject*, TrackedReceiver> ReceiverMap;
+    ReceiverMap trackedReceivers;
+
+    ReceiverMap::iterator trackReceiver(TQObject* receiver);
+    void trackSignalReceiver(TQObject* receiver, const char* slot, const TQString& hook,
+                             const TQString& rule, bool batch = false);
+    // returns the number of connections removed, each holds a reference of
+    // the hook and the match rule
+    uint untrackSignalReceiver(TQObject* receiver, const char* slot, const TQString& hook,
+                               const TQString& rule, bool batch = false);
+    void releaseSignalHook(const TQString& key);
+    void releaseBatchHook(const TQString& key);
+
+    void linkPendingCall(TQT_DBusPendingCall* call);
+    void unlinkPendingCall(TQT_DBusPendingCall* call);
+
     typedef TQValueList<TQT_DBusMessage> PendingMessagesForEmit;
     PendingMessagesForEmit pendingMessages;
+    bool coalescePropertiesChanged;
+
+    // timeout of calls whose message has TQT_DBusMessage::DefaultTimeout
+    // and the number of calls which did not get their reply in time
+    int defaultTimeout;
+    uint timedOutCalls;
+
+    int callTimeout(const TQT_DBusMessage& message) const;
+    void checkTimedOut(const TQT_DBusError& error);
+
+    // synchronous calls running the event loop while waiting for the reply
+    bool processEventsDuringCalls;
+    bool canProcessEventsDuringCall() const;
+    DBusMessage* sendWithReplyAndProcessEvents(DBusMessage* msg, int timeout);
 
     bool inDispatch;
 
@@ -23,6 +23,8 @@
 
 #include "dbus/dbus.h"
 
+#include "tqdbusarena_p.h"
+#include "tqdbusatomic.h"
 #include "tqdbusdata.h"
 #include "tqdbusdatalist.h"
 #include "tqdbusdatamap.h"
@@ -30,21 +32,27 @@
 #include "tqdbusunixfd.h"
 #include "tqdbusvariant.h"
 
-#include <tqshared.h>
 #include <tqstring.h>
 #include <tqvaluelist.h>
 
-class TQT_DBusData::Private : public TQShared
+#include <new>
+
+#include <string.h>
+
+class TQT_DBusData::Private
 {
 public:
-    Private() : TQShared(), type(TQT_DBusData::Invalid), keyType(TQT_DBusData::Invalid) {}
+    Private() : refCount(1), type(TQT_DBusData::Invalid), keyType(TQT_DBusData::Invalid),
+                arena(0), signature(0), signatureOnHeap(false) {}
 
     ~Private()
     {
+        if (signatureOnHeap) delete[] signature;
+
         switch (type)
         {
             case TQT_DBusData::String:
-                delete (TQString*)value.pointer;
+                stringValue()->~TQString();
                 break;
 
             case TQT_DBusData::ObjectPath:
@@ -123,6 +131,11 @@ public:
     }
 
 public:
+    // same semantics as TQShared but safe for copies on several threads
+    Atomic refCount;
+    inline void ref() { refCount.ref(); }
+    inline bool deref() { return !refCount.deref(); }
+
     Type type;
     Type keyType;
 
@@ -138,9 +151,268 @@ public:
         TQ_UINT64 uint64Value;
         double doubleValue;
         void* pointer;
+
+        // TQString is just a pointer to its shared data, so it is
+        // constructed in place instead of being allocated separately
+        char stringStorage[sizeof(TQString)];
     } value;
+
+    TQString* stringValue() { return (TQString*) value.stringStorage; }
+
+    // allocated from the current arena if there is one
+    TQT_DBusArena* arena;
+
+    // signature of a container, set once when it is created. Containers
+    // never change afterwards, so it can be read from any thread
+    char* signature;
+    bool signatureOnHeap;
+
+    void setSignature(const TQCString& containerSignature);
+
+    static Private* create();
+    static void destroy(Private* data);
+
+    // heap allocated copy of a value allocated from an arena, including
+    // the values of containers
+    static Private* copyOut(const Private* data);
+
+    template <typename T>
+    static void* copyMapOut(const void* pointer);
+
+    // values of a message are only shared with its arena while they are
+    // de-marshalled, copies made afterwards are retained by the application
+    static bool needsCopyOut(const Private* data)
+    {
+        return data->arena != 0 && data->arena != TQT_DBusArena::current();
+    }
+
+    // immutable values shared by all data objects using them. They keep
+    // one reference for themselves and are thus never deleted
+    static Private* sharedNull();
+    static Private* sharedBool(bool value);
+    static Private* sharedInt32Zero();
+    static Private* sharedUInt32Zero();
+    static Private* sharedEmptyString();
 };
 
+TQT_DBusData::Private* TQT_DBusData::Private::create()
+{
+    TQT_DBusArena* arena = TQT_DBusArena::current();
+    if (arena == 0) return new Private();
+
+    void* memory = arena->allocate(sizeof(Private));
+    if (memory == 0) return new Private();
+
+    Private* data = new (memory) Private();
+    data->arena = arena;
+    arena->ref();
+
+    return data;
+}
+
+void TQT_DBusData::Private::setSignature(const TQCString& containerSignature)
+{
+    uint size = containerSignature.length() + 1;
+
+    // released together with the arena if allocated from it
+    void* memory = (arena != 0) ? arena->allocate(size) : 0;
+    if (memory != 0)
+        signature = (char*) memory;
+    else
+    {
+        signature = new char[size];
+        signatureOnHeap = true;
+    }
+
+    memcpy(signature, containerSignature.data(), size);
+}
+
+template <typename T>
+void* TQT_DBusData::Private::copyMapOut(const void* pointer)
+{
+    TQT_DBusDataMap<T>* map = new TQT_DBusDataMap<T>(*(const TQT_DBusDataMap<T>*) pointer);
+
+    // detaching copies the values, which copies them out as well
+    map->begin();
+
+    return map;
+}
+
+TQT_DBusData::Private* TQT_DBusData::Private::copyOut(const Private* data)
+{
+    Private* copy = new Private();
+    copy->type    = data->type;
+    copy->keyType = data->keyType;
+    copy->value   = data->value;
+
+    if (data->signature != 0) copy->setSignature(TQCString(data->signature));
+
+    switch (data->type)
+    {
+        case TQT_DBusData::String:
+            new (copy->value.stringStorage) TQString(*(const TQString*) data->value.stringStorage);
+            break;
+
+        case TQT_DBusData::ObjectPath:
+            copy->value.pointer =
+                new TQT_DBusObjectPath(*(const TQT_DBusObjectPath*) data->value.pointer);
+            break;
+
+        case TQT_DBusData::UnixFd:
+            copy->value.pointer =
+                new TQT_DBusUnixFd(*(const TQT_DBusUnixFd*) data->value.pointer);
+            break;
+
+        case TQT_DBusData::List:
+            copy->value.pointer =
+                new TQT_DBusDataList(((const TQT_DBusDataList*) data->value.pointer)->deepCopy());
+            break;
+
+        case TQT_DBusData::Struct:
+        {
+            TQValueList<TQT_DBusData>* members =
+                new TQValueList<TQT_DBusData>(*(const TQValueList<TQT_DBusData>*) data->value.pointer);
+
+            // detaching copies the members, which copies them out as well
+            members->begin();
+
+            copy->value.pointer = members;
+            break;
+        }
+
+        case TQT_DBusData::Variant:
+            // copying the variant's value copies it out
+            copy->value.pointer = new TQT_DBusVariant(*(const TQT_DBusVariant*) data->value.pointer);
+            break;
+
+        case TQT_DBusData::Map:
+            switch (data->keyType)
+            {
+                case TQT_DBusData::Byte:
+                    copy->value.pointer = copyMapOut<TQ_UINT8>(data->value.pointer);
+                    break;
+
+                case TQT_DBusData::Int16:
+                    copy->value.pointer = copyMapOut<TQ_INT16>(data->value.pointer);
+                    break;
+
+                case TQT_DBusData::UInt16:
+                    copy->value.pointer = copyMapOut<TQ_UINT16>(data->value.pointer);
+                    break;
+
+                case TQT_DBusData::Int32:
+                    copy->value.pointer = copyMapOut<TQ_INT32>(data->value.pointer);
+                    break;
+
+                case TQT_DBusData::UInt32:
+                    copy->value.pointer = copyMapOut<TQ_UINT32>(data->value.pointer);
+                    break;
+
+                case TQT_DBusData::Int64:
+                    copy->value.pointer = copyMapOut<TQ_INT64>(data->value.pointer);
+                    break;
+
+                case TQT_DBusData::UInt64:
+                    copy->value.pointer = copyMapOut<TQ_UINT64>(data->value.pointer);
+                    break;
+
+                case TQT_DBusData::String:
+                    copy->value.pointer = copyMapOut<TQString>(data->value.pointer);
+                    break;
+
+                case TQT_DBusData::ObjectPath:
+                    copy->value.pointer = copyMapOut<TQT_DBusObjectPath>(data->value.pointer);
+                    break;
+
+                case TQT_DBusData::UnixFd:
+                    copy->value.pointer = copyMapOut<TQT_DBusUnixFd>(data->value.pointer);
+                    break;
+
+                default:
+                    tqFatal("TQT_DBusData::Private: unhandled map key type %d(%s)",
+                           data->keyType, TQT_DBusData::typeName(data->keyType));
+                    break;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    return copy;
+}
+
+void TQT_DBusData::Private::destroy(Private* data)
+{
+    TQT_DBusArena* arena = data->arena;
+    if (arena == 0)
+    {
+        delete data;
+        return;
+    }
+
+    // memory is released together with the arena
+    data->~Private();
+    arena->deref();
+}
+
+// the shared values are created on first use, which is thread-safe for
+// function local statics
+
+TQT_DBusData::Private* TQT_DBusData::Private::sharedNull()
+{
+    static Private* shared = new Private();
+    return shared;
+}
+
+static TQT_DBusData::Private* qCreateShared(TQT_DBusData::Type type)
+{
+    TQT_DBusData::Private* shared = new TQT_DBusData::Private();
+    shared->type = type;
+    shared->value.uint64Value = 0;
+    return shared;
+}
+
+static TQT_DBusData::Private* qCreateSharedTrue()
+{
+    TQT_DBusData::Private* shared = qCreateShared(TQT_DBusData::Bool);
+    shared->value.boolValue = true;
+    return shared;
+}
+
+TQT_DBusData::Private* TQT_DBusData::Private::sharedBool(bool value)
+{
+    static Private* sharedFalse = qCreateShared(TQT_DBusData::Bool);
+    static Private* sharedTrue  = qCreateSharedTrue();
+
+    return value ? sharedTrue : sharedFalse;
+}
+
+TQT_DBusData::Private* TQT_DBusData::Private::sharedInt32Zero()
+{
+    static Private* shared = qCreateShared(TQT_DBusData::Int32);
+    return shared;
+}
+
+TQT_DBusData::Private* TQT_DBusData::Private::sharedUInt32Zero()
+{
+    static Private* shared = qCreateShared(TQT_DBusData::UInt32);
+    return shared;
+}
+
+static TQT_DBusData::Private* qCreateSharedEmptyString()
+{
+    TQT_DBusData::Private* shared = qCreateShared(TQT_DBusData::String);
+    new (shared->value.stringStorage) TQString(TQString::fromLatin1(""));
+    return shared;
+}
+
+TQT_DBusData::Private* TQT_DBusData::Private::sharedEmptyString()
+{
+    static Private* shared = qCreateSharedEmptyString();
+    return shared;
+}
+
 // key type definitions for TQT_DBusDataMap
 template <>
 const TQT_DBusData::Type TQT_DBusDataMap<TQ_UINT8>::m_keyType = TQT_DBusData::Byte;
@@ -173,12 +445,23 @@ template <>
 const TQT_DBusData::Type TQT_DBusDataMap<TQT_DBusUnixFd>::m_keyType = TQT_DBusData::UnixFd;
 
 
-TQT_DBusData::TQT_DBusData() : d(new Private())
+TQT_DBusData::TQT_DBusData() : d(Private::sharedNull())
+{
+    d->ref();
+}
+
+TQT_DBusData::TQT_DBusData(Private* data) : d(data)
 {
 }
 
 TQT_DBusData::TQT_DBusData(const TQT_DBusData& other) : d(0)
 {
+    if (Private::needsCopyOut(other.d))
+    {
+        d = Private::copyOut(other.d);
+        return;
+    }
+
     d = other.d;
 
     d->ref();
@@ -186,18 +469,22 @@ TQT_DBusData::TQT_DBusData(const TQT_DBusData& other) : d(0)
 
 TQT_DBusData::~TQT_DBusData()
 {
-    if (d->deref()) delete d;
+    if (d->deref()) Private::destroy(d);
 }
 
 TQT_DBusData& TQT_DBusData::operator=(const TQT_DBusData& other)
 {
     if (&other == this) return *this;
 
-    if (d->deref()) delete d;
+    Private* data = other.d;
+    if (Private::needsCopyOut(data))
+        data = Private::copyOut(data);
+    else
+        data->ref();
 
-    d = other.d;
+    if (d->deref()) Private::destroy(d);
 
-    d->ref();
+    d = data;
 
     return *this;
 }
@@ -354,12 +641,10 @@ const char* TQT_DBusData::typeName(Type type)
 
 TQT_DBusData TQT_DBusData::fromBool(bool value)
 {
-    TQT_DBusData data;
+    Private* shared = Private::sharedBool(value);
+    shared->ref();
 
-    data.d->type = TQT_DBusData::Bool;
-    data.d->value.boolValue = value;
-
-    return data;
+    return TQT_DBusData(shared);
 }
 
 bool TQT_DBusData::toBool(bool* ok) const
@@ -377,7 +662,7 @@ bool TQT_DBusData::toBool(bool* ok) const
 
 TQT_DBusData TQT_DBusData::fromByte(TQ_UINT8 value)
 {
-    TQT_DBusData data;
+    TQT_DBusData data(Private::create());
 
     data.d->type = TQT_DBusData::Byte;
     data.d->value.byteValue = value;
@@ -400,7 +685,7 @@ TQ_UINT8 TQT_DBusData::toByte(bool* ok) const
 
 TQT_DBusData TQT_DBusData::fromInt16(TQ_INT16 value)
 {
-    TQT_DBusData data;
+    TQT_DBusData data(Private::create());
 
     data.d->type = TQT_DBusData::Int16;
     data.d->value.int16Value = value;
@@ -423,7 +708,7 @@ TQ_INT16 TQT_DBusData::toInt16(bool* ok) const
 
 TQT_DBusData TQT_DBusData::fromUInt16(TQ_UINT16 value)
 {
-    TQT_DBusData data;
+    TQT_DBusData data(Private::create());
 
     data.d->type = TQT_DBusData::UInt16;
     data.d->value.uint16Value = value;
@@ -446,7 +731,15 @@ TQ_UINT16 TQT_DBusData::toUInt16(bool* ok) const
 
 TQT_DBusData TQT_DBusData::fromInt32(TQ_INT32 value)
 {
-    TQT_DBusData data;
+    if (value == 0)
+    {
+        Private* shared = Private::sharedInt32Zero();
+        shared->ref();
+
+        return TQT_DBusData(shared);
+    }
+
+    TQT_DBusData data(Private::create());
 
     data.d->type = TQT_DBusData::Int32;
     data.d->value.int32Value = value;
@@ -469,7 +762,15 @@ TQ_INT32 TQT_DBusData::toInt32(bool* ok) const
 
 TQT_DBusData TQT_DBusData::fromUInt32(TQ_UINT32 value)
 {
-    TQT_DBusData data;
+    if (value == 0)
+    {
+        Private* shared = Private::sharedUInt32Zero();
+        shared->ref();
+
+        return TQT_DBusData(shared);
+    }
+
+    TQT_DBusData data(Private::create());
 
     data.d->type = TQT_DBusData::UInt32;
     data.d->value.uint32Value = value;
@@ -492,7 +793,7 @@ TQ_UINT32 TQT_DBusData::toUInt32(bool* ok) const
 
 TQT_DBusData TQT_DBusData::fromInt64(TQ_INT64 value)
 {
-    TQT_DBusData data;
+    TQT_DBusData data(Private::create());
 
     data.d->type = TQT_DBusData::Int64;
     data.d->value.int64Value = value;
@@ -515,7 +816,7 @@ TQ_INT64 TQT_DBusData::toInt64(bool* ok) const
 
 TQT_DBusData TQT_DBusData::fromUInt64(TQ_UINT64 value)
 {
-    TQT_DBusData data;
+    TQT_DBusData data(Private::create());
 
     data.d->type = TQT_DBusData::UInt64;
     data.d->value.uint64Value = value;
@@ -538,7 +839,7 @@ TQ_UINT64 TQT_DBusData::toUInt64(bool* ok) const
 
 TQT_DBusData TQT_DBusData::fromDouble(double value)
 {
-    TQT_DBusData data;
+    TQT_DBusData data(Private::create());
 
     data.d->type = TQT_DBusData::Double;
     data.d->value.doubleValue = value;
@@ -561,10 +862,19 @@ double TQT_DBusData::toDouble(bool* ok) const
 
 TQT_DBusData TQT_DBusData::fromString(const TQString& value)
 {
-    TQT_DBusData data;
+    // keep null strings distinguishable from empty ones
+    if (value.isEmpty() && !value.isNull())
+    {
+        Private* shared = Private::sharedEmptyString();
+        shared->ref();
+
+        return TQT_DBusData(shared);
+    }
+
+    TQT_DBusData data(Private::create());
 
     data.d->type = TQT_DBusData::String;
-    data.d->value.pointer = new TQString(value);
+    new (data.d->value.stringStorage) TQString(value);
 
     return data;
 }
@@ -579,12 +889,17 @@ TQString TQT_DBusData::toString(bool* ok) const
 
     if (ok != 0) *ok = true;
 
-    return *((TQString*)d->value.pointer);
+    // the shared empty string is used by all threads, so it must not be
+    // shallow copied
+    if (d == Private::sharedEmptyString())
+        return TQString::fromLatin1("");
+
+    return *d->stringValue();
 }
 
 TQT_DBusData TQT_DBusData::fromObjectPath(const TQT_DBusObjectPath& value)
 {
-    TQT_DBusData data;
+    TQT_DBusData data(Private::create());
 
     if (value.isValid())
     {
@@ -610,7 +925,7 @@ TQT_DBusObjectPath TQT_DBusData::toObjectPath(bool* ok) const
 
 TQT_DBusData TQT_DBusData::fromUnixFd(const TQT_DBusUnixFd& value)
 {
-    TQT_DBusData data;
+    TQT_DBusData data(Private::create());
 
     if (value.isValid())
     {
@@ -636,12 +951,13 @@ TQT_DBusUnixFd TQT_DBusData::toUnixFd(bool* ok) const
 
 TQT_DBusData TQT_DBusData::fromList(const TQT_DBusDataList& list)
 {
-    TQT_DBusData data;
+    TQT_DBusData data(Private::create());
 
     if (list.type() == TQT_DBusData::Invalid) return data;
 
     data.d->type = TQT_DBusData::List;
     data.d->value.pointer = new TQT_DBusDataList(list);
+    data.d->setSignature(data.buildDBusSignature());
 
     return data;
 }
@@ -680,7 +996,7 @@ TQValueList<TQT_DBusData> TQT_DBusData::toTQValueList(bool* ok) const
 
 TQT_DBusData TQT_DBusData::fromStruct(const TQValueList<TQT_DBusData>& memberList)
 {
-    TQT_DBusData data;
+    TQT_DBusData data(Private::create());
 
     TQValueList<TQT_DBusData>::const_iterator it    = memberList.begin();
     TQValueList<TQT_DBusData>::const_iterator endIt = memberList.end();
@@ -691,6 +1007,7 @@ TQT_DBusData TQT_DBusData::fromStruct(const TQValueList<TQT_DBusData>& memberLis
 
     data.d->type = TQT_DBusData::Struct;
     data.d->value.pointer = new TQValueList<TQT_DBusData>(memberList);
+    data.d->setSignature(data.buildDBusSignature());
 
     return data;
 }
@@ -710,7 +1027,7 @@ TQValueList<TQT_DBusData> TQT_DBusData::toStruct(bool* ok) const
 
 TQT_DBusData TQT_DBusData::fromVariant(const TQT_DBusVariant& value)
 {
-    TQT_DBusData data;
+    TQT_DBusData data(Private::create());
 
     data.d->type = TQT_DBusData::Variant;
     data.d->value.pointer = new TQT_DBusVariant(value);
@@ -741,11 +1058,12 @@ TQT_DBusData TQT_DBusData::getAsVariantData()
 
 TQT_DBusData TQT_DBusData::fromByteKeyMap(const TQT_DBusDataMap<TQ_UINT8>& map)
 {
-    TQT_DBusData data;
+    TQT_DBusData data(Private::create());
 
     data.d->type = TQT_DBusData::Map;
     data.d->keyType = map.keyType();
     data.d->value.pointer = new TQT_DBusDataMap<TQ_UINT8>(map);
+    data.d->setSignature(data.buildDBusSignature());
 
     return data;
 }
@@ -765,11 +1083,12 @@ TQT_DBusDataMap<TQ_UINT8> TQT_DBusData::toByteKeyMap(bool* ok) const
 
 TQT_DBusData TQT_DBusData::fromInt16KeyMap(const TQT_DBusDataMap<TQ_INT16>& map)
 {
-    TQT_DBusData data;
+    TQT_DBusData data(Private::create());
 
     data.d->type = TQT_DBusData::Map;
     data.d->keyType = map.keyType();
     data.d->value.pointer = new TQT_DBusDataMap<TQ_INT16>(map);
+    data.d->setSignature(data.buildDBusSignature());
 
     return data;
 }
@@ -789,11 +1108,12 @@ TQT_DBusDataMap<TQ_INT16> TQT_DBusData::toInt16KeyMap(bool* ok) const
 
 TQT_DBusData TQT_DBusData::fromUInt16KeyMap(const TQT_DBusDataMap<TQ_UINT16>& map)
 {
-    TQT_DBusData data;
+    TQT_DBusData data(Private::create());
 
     data.d->type = TQT_DBusData::Map;
     data.d->keyType = map.keyType();
     data.d->value.pointer = new TQT_DBusDataMap<TQ_UINT16>(map);
+    data.d->setSignature(data.buildDBusSignature());
 
     return data;
 }
@@ -814,11 +1134,12 @@ TQT_DBusDataMap<TQ_UINT16> TQT_DBusData::toUInt16KeyMap(bool* ok) const
 
 TQT_DBusData TQT_DBusData::fromInt32KeyMap(const TQT_DBusDataMap<TQ_INT32>& map)
 {
-    TQT_DBusData data;
+    TQT_DBusData data(Private::create());
 
     data.d->type = TQT_DBusData::Map;
     data.d->keyType = map.keyType();
     data.d->value.pointer = new TQT_DBusDataMap<TQ_INT32>(map);
+    data.d->setSignature(data.buildDBusSignature());
 
     return data;
 }
@@ -838,11 +1159,12 @@ TQT_DBusDataMap<TQ_INT32> TQT_DBusData::toInt32KeyMap(bool* ok) const
 
 TQT_DBusData TQT_DBusData::fromUInt32KeyMap(const TQT_DBusDataMap<TQ_UINT32>& map)
 {
-    TQT_DBusData data;
+    TQT_DBusData data(Private::create());
 
     data.d->type = TQT_DBusData::Map;
     data.d->keyType = map.keyType();
     data.d->value.pointer = new TQT_DBusDataMap<TQ_UINT32>(map);
+    data.d->setSignature(data.buildDBusSignature());
 
     return data;
 }
@@ -863,11 +1185,12 @@ TQT_DBusDataMap<TQ_UINT32> TQT_DBusData::toUInt32KeyMap(bool* ok) const
 
 TQT_DBusData TQT_DBusData::fromInt64KeyMap(const TQT_DBusDataMap<TQ_INT64>& map)
 {
-    TQT_DBusData data;
+    TQT_DBusData data(Private::create());
 
     data.d->type = TQT_DBusData::Map;
     data.d->keyType = map.keyType();
     data.d->value.pointer = new TQT_DBusDataMap<TQ_INT64>(map);
+    data.d->setSignature(data.buildDBusSignature());
 
     return data;
 }
@@ -887,11 +1210,12 @@ TQT_DBusDataMap<TQ_INT64> TQT_DBusData::toInt64KeyMap(bool* ok) const
 
 TQT_DBusData TQT_DBusData::fromUInt64KeyMap(const TQT_DBusDataMap<TQ_UINT64>& map)
 {
-    TQT_DBusData data;
+    TQT_DBusData data(Private::create());
 
     data.d->type = TQT_DBusData::Map;
     data.d->keyType = map.keyType();
     data.d->value.pointer = new TQT_DBusDataMap<TQ_UINT64>(map);
+    data.d->setSignature(data.buildDBusSignature());
 
     return data;
 }
@@ -912,11 +1236,12 @@ TQT_DBusDataMap<TQ_UINT64> TQT_DBusData::toUInt64KeyMap(bool* ok) const
 
 TQT_DBusData TQT_DBusData::fromStringKeyMap(const TQT_DBusDataMap<TQString>& map)
 {
-    TQT_DBusData data;
+    TQT_DBusData data(Private::create());
 
     data.d->type = TQT_DBusData::Map;
     data.d->keyType = map.keyType();
     data.d->value.pointer = new TQT_DBusDataMap<TQString>(map);
+    data.d->setSignature(data.buildDBusSignature());
 
     return data;
 }
@@ -936,11 +1261,12 @@ TQT_DBusDataMap<TQString> TQT_DBusData::toStringKeyMap(bool* ok) const
 
 TQT_DBusData TQT_DBusData::fromObjectPathKeyMap(const TQT_DBusDataMap<TQT_DBusObjectPath>& map)
 {
-    TQT_DBusData data;
+    TQT_DBusData data(Private::create());
 
     data.d->type = TQT_DBusData::Map;
     data.d->keyType = map.keyType();
     data.d->value.pointer = new TQT_DBusDataMap<TQT_DBusObjectPath>(map);
+    data.d->setSignature(data.buildDBusSignature());
 
     return data;
 }
@@ -961,11 +1287,12 @@ TQT_DBusDataMap<TQT_DBusObjectPath> TQT_DBusData::toObjectPathKeyMap(bool* ok) c
 
 TQT_DBusData TQT_DBusData::fromUnixFdKeyMap(const TQT_DBusDataMap<TQT_DBusUnixFd>& map)
 {
-    TQT_DBusData data;
+    TQT_DBusData data(Private::create());
 
     data.d->type = TQT_DBusData::Map;
     data.d->keyType = map.keyType();
     data.d->value.pointer = new TQT_DBusDataMap<TQT_DBusUnixFd>(map);
+    data.d->setSignature(data.buildDBusSignature());
 
     return data;
 }
@@ -1033,6 +1360,9 @@ TQCString qDBusSignatureForMapValue(const TQT_DBusDataMap<T>& map)
 
 TQCString TQT_DBusData::buildDBusSignature() const
 {
+    // containers get theirs when they are created
+    if (d->signature != 0) return TQCString(d->signature);
+
     TQCString signature;
 
     switch (d->type)
@@ -1127,3 +1457,17 @@ TQCString TQT_DBusData::buildDBusSignature() const
 
     return signature;
 }
+
+bool TQT_DBusData::hasSameSignature(const TQT_DBusData& other) const
+{
+    if (d == other.d) return true;
+
+    if (d->type != other.d->type) return false;
+
+    // only containers have a cached signature, other types are fully
+    // described by their type
+    if (d->signature == 0 || other.d->signature == 0)
+        return d->signature == other.d->signature;
+
+    return qstrcmp(d->signature, other.d->signature) == 0;
+}
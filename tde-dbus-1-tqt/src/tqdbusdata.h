@@ -51,6 +51,13 @@ template<typename T> class TQT_DBusDataMap;
  * construct of TQT_DBusData objects, e.g. a #List can contain elements that are
  * containers themselves, e.g. #Map, #Struct, #Variant or even #List again.
  *
+ * @note the reference count of the shared content is changed atomically, so
+ *       copies of a TQT_DBusData object can be created and destroyed on
+ *       different threads. This does not extend to TQt's own implicitly
+ *       shared classes, e.g. TQString or TQValueList: content of these types
+ *       must only be accessed by one thread at a time, so a value should be
+ *       handed to another thread rather than being used by both.
+ *
  * @see TQT_DBusDataList
  * @see TQT_DBusDataMap
  * @see TQT_DBusDataConverter
@@ -1222,8 +1229,24 @@ public:
      */
     TQCString buildDBusSignature() const;
 
+    /**
+     * @brief Checks whether two data objects have the same D-Bus signature
+     *
+     * Same result as comparing the two objects' buildDBusSignature() but
+     * without building any strings, since the signature of a container is
+     * determined once when the container is created.
+     *
+     * @param other the data object to compare with
+     *
+     * @return @c true if both objects have the same signature, otherwise
+     *         @c false
+     */
+    bool hasSameSignature(const TQT_DBusData& other) const;
+
 private:
     class Private;
+    TQT_DBusData(Private* data);
+
     Private* d;
 };
 
@@ -23,12 +23,17 @@
 
 #include "tqdbusdataconverter.h"
 #include "tqdbusdata.h"
+#include "tqdbusmarshall.h"
+#include "tqdbusobjectpath.h"
 
 #include <tqpoint.h>
 #include <tqrect.h>
 #include <tqsize.h>
+#include <tqstringlist.h>
 #include <tqvaluelist.h>
 
+#include <dbus/dbus.h>
+
 template <>
 TQT_DBusDataConverter::Result TQT_DBusDataConverter::convertFromTQT_DBusData<TQRect>(const TQT_DBusData& dbusData, TQRect& typeData)
 {
@@ -141,3 +146,331 @@ TQT_DBusDataConverter::Result TQT_DBusDataConverter::convertToTQT_DBusData<TQSiz
     
     return Success;
 }
+
+TQT_DBusDataConverter::Result TQT_DBusDataConverter::appendData(const TQT_DBusData& dbusData, DBusMessageIter* iter)
+{
+    return TQT_DBusMarshall::dataToIterator(dbusData, iter) ? Success : InvalidArgument;
+}
+
+TQT_DBusDataConverter::Result TQT_DBusDataConverter::readData(DBusMessageIter* iter, TQT_DBusData& dbusData)
+{
+    dbusData = TQT_DBusMarshall::iteratorToData(iter);
+
+    return dbusData.isValid() ? Success : InvalidSignature;
+}
+
+template <typename T>
+static inline TQT_DBusDataConverter::Result qAppendBasic(DBusMessageIter* iter, int dbusType, T value)
+{
+    if (!dbus_message_iter_append_basic(iter, dbusType, &value))
+        return TQT_DBusDataConverter::InvalidArgument;
+
+    return TQT_DBusDataConverter::Success;
+}
+
+template <typename T>
+static inline TQT_DBusDataConverter::Result qReadBasic(DBusMessageIter* iter, int dbusType, T& value)
+{
+    if (dbus_message_iter_get_arg_type(iter) != dbusType)
+        return TQT_DBusDataConverter::InvalidSignature;
+
+    dbus_message_iter_get_basic(iter, &value);
+
+    return TQT_DBusDataConverter::Success;
+}
+
+static TQT_DBusDataConverter::Result qAppendInt32Struct(DBusMessageIter* iter,
+                                                       const dbus_int32_t* values, uint count)
+{
+    DBusMessageIter structIter;
+    if (!dbus_message_iter_open_container(iter, DBUS_TYPE_STRUCT, 0, &structIter))
+        return TQT_DBusDataConverter::InvalidArgument;
+
+    for (uint i = 0; i < count; ++i)
+    {
+        dbus_message_iter_append_basic(&structIter, DBUS_TYPE_INT32, &values[i]);
+    }
+
+    if (!dbus_message_iter_close_container(iter, &structIter))
+        return TQT_DBusDataConverter::InvalidArgument;
+
+    return TQT_DBusDataConverter::Success;
+}
+
+static TQT_DBusDataConverter::Result qReadInt32Struct(DBusMessageIter* iter,
+                                                     dbus_int32_t* values, uint count)
+{
+    if (dbus_message_iter_get_arg_type(iter) != DBUS_TYPE_STRUCT)
+        return TQT_DBusDataConverter::InvalidSignature;
+
+    DBusMessageIter structIter;
+    dbus_message_iter_recurse(iter, &structIter);
+
+    for (uint i = 0; i < count; ++i)
+    {
+        if (dbus_message_iter_get_arg_type(&structIter) != DBUS_TYPE_INT32)
+            return TQT_DBusDataConverter::InvalidSignature;
+
+        dbus_message_iter_get_basic(&structIter, &values[i]);
+        dbus_message_iter_next(&structIter);
+    }
+
+    // too many members
+    if (dbus_message_iter_get_arg_type(&structIter) != DBUS_TYPE_INVALID)
+        return TQT_DBusDataConverter::InvalidSignature;
+
+    return TQT_DBusDataConverter::Success;
+}
+
+template <>
+TQT_DBusDataConverter::Result TQT_DBusDataConverter::convertToDBusMessageIter<bool>(const bool& typeData, DBusMessageIter* iter)
+{
+    dbus_bool_t value = typeData ? TRUE : FALSE;
+    return qAppendBasic(iter, DBUS_TYPE_BOOLEAN, value);
+}
+
+template <>
+TQT_DBusDataConverter::Result TQT_DBusDataConverter::convertFromDBusMessageIter<bool>(DBusMessageIter* iter, bool& typeData)
+{
+    dbus_bool_t value = FALSE;
+    Result result = qReadBasic(iter, DBUS_TYPE_BOOLEAN, value);
+    if (result == Success) typeData = (value != FALSE);
+
+    return result;
+}
+
+template <>
+TQT_DBusDataConverter::Result TQT_DBusDataConverter::convertToDBusMessageIter<TQ_UINT8>(const TQ_UINT8& typeData, DBusMessageIter* iter)
+{
+    return qAppendBasic(iter, DBUS_TYPE_BYTE, typeData);
+}
+
+template <>
+TQT_DBusDataConverter::Result TQT_DBusDataConverter::convertFromDBusMessageIter<TQ_UINT8>(DBusMessageIter* iter, TQ_UINT8& typeData)
+{
+    return qReadBasic(iter, DBUS_TYPE_BYTE, typeData);
+}
+
+template <>
+TQT_DBusDataConverter::Result TQT_DBusDataConverter::convertToDBusMessageIter<TQ_INT16>(const TQ_INT16& typeData, DBusMessageIter* iter)
+{
+    return qAppendBasic(iter, DBUS_TYPE_INT16, typeData);
+}
+
+template <>
+TQT_DBusDataConverter::Result TQT_DBusDataConverter::convertFromDBusMessageIter<TQ_INT16>(DBusMessageIter* iter, TQ_INT16& typeData)
+{
+    return qReadBasic(iter, DBUS_TYPE_INT16, typeData);
+}
+
+template <>
+TQT_DBusDataConverter::Result TQT_DBusDataConverter::convertToDBusMessageIter<TQ_UINT16>(const TQ_UINT16& typeData, DBusMessageIter* iter)
+{
+    return qAppendBasic(iter, DBUS_TYPE_UINT16, typeData);
+}
+
+template <>
+TQT_DBusDataConverter::Result TQT_DBusDataConverter::convertFromDBusMessageIter<TQ_UINT16>(DBusMessageIter* iter, TQ_UINT16& typeData)
+{
+    return qReadBasic(iter, DBUS_TYPE_UINT16, typeData);
+}
+
+template <>
+TQT_DBusDataConverter::Result TQT_DBusDataConverter::convertToDBusMessageIter<TQ_INT32>(const TQ_INT32& typeData, DBusMessageIter* iter)
+{
+    return qAppendBasic(iter, DBUS_TYPE_INT32, typeData);
+}
+
+template <>
+TQT_DBusDataConverter::Result TQT_DBusDataConverter::convertFromDBusMessageIter<TQ_INT32>(DBusMessageIter* iter, TQ_INT32& typeData)
+{
+    return qReadBasic(iter, DBUS_TYPE_INT32, typeData);
+}
+
+template <>
+TQT_DBusDataConverter::Result TQT_DBusDataConverter::convertToDBusMessageIter<TQ_UINT32>(const TQ_UINT32& typeData, DBusMessageIter* iter)
+{
+    return qAppendBasic(iter, DBUS_TYPE_UINT32, typeData);
+}
+
+template <>
+TQT_DBusDataConverter::Result TQT_DBusDataConverter::convertFromDBusMessageIter<TQ_UINT32>(DBusMessageIter* iter, TQ_UINT32& typeData)
+{
+    return qReadBasic(iter, DBUS_TYPE_UINT32, typeData);
+}
+
+template <>
+TQT_DBusDataConverter::Result TQT_DBusDataConverter::convertToDBusMessageIter<TQ_INT64>(const TQ_INT64& typeData, DBusMessageIter* iter)
+{
+    return qAppendBasic(iter, DBUS_TYPE_INT64, typeData);
+}
+
+template <>
+TQT_DBusDataConverter::Result TQT_DBusDataConverter::convertFromDBusMessageIter<TQ_INT64>(DBusMessageIter* iter, TQ_INT64& typeData)
+{
+    return qReadBasic(iter, DBUS_TYPE_INT64, typeData);
+}
+
+template <>
+TQT_DBusDataConverter::Result TQT_DBusDataConverter::convertToDBusMessageIter<TQ_UINT64>(const TQ_UINT64& typeData, DBusMessageIter* iter)
+{
+    return qAppendBasic(iter, DBUS_TYPE_UINT64, typeData);
+}
+
+template <>
+TQT_DBusDataConverter::Result TQT_DBusDataConverter::convertFromDBusMessageIter<TQ_UINT64>(DBusMessageIter* iter, TQ_UINT64& typeData)
+{
+    return qReadBasic(iter, DBUS_TYPE_UINT64, typeData);
+}
+
+template <>
+TQT_DBusDataConverter::Result TQT_DBusDataConverter::convertToDBusMessageIter<double>(const double& typeData, DBusMessageIter* iter)
+{
+    return qAppendBasic(iter, DBUS_TYPE_DOUBLE, typeData);
+}
+
+template <>
+TQT_DBusDataConverter::Result TQT_DBusDataConverter::convertFromDBusMessageIter<double>(DBusMessageIter* iter, double& typeData)
+{
+    return qReadBasic(iter, DBUS_TYPE_DOUBLE, typeData);
+}
+
+template <>
+TQT_DBusDataConverter::Result TQT_DBusDataConverter::convertToDBusMessageIter<TQString>(const TQString& typeData, DBusMessageIter* iter)
+{
+    TQCString utf8 = typeData.utf8();
+    const char* value = utf8.data();
+    if (value == 0) value = "";
+
+    return qAppendBasic(iter, DBUS_TYPE_STRING, value);
+}
+
+template <>
+TQT_DBusDataConverter::Result TQT_DBusDataConverter::convertFromDBusMessageIter<TQString>(DBusMessageIter* iter, TQString& typeData)
+{
+    const char* value = 0;
+    Result result = qReadBasic(iter, DBUS_TYPE_STRING, value);
+    if (result == Success) typeData = TQString::fromUtf8(value);
+
+    return result;
+}
+
+template <>
+TQT_DBusDataConverter::Result TQT_DBusDataConverter::convertToDBusMessageIter<TQT_DBusObjectPath>(const TQT_DBusObjectPath& typeData, DBusMessageIter* iter)
+{
+    if (!typeData.isValid()) return InvalidArgument;
+
+    TQCString utf8 = typeData.utf8();
+    const char* value = utf8.data();
+
+    return qAppendBasic(iter, DBUS_TYPE_OBJECT_PATH, value);
+}
+
+template <>
+TQT_DBusDataConverter::Result TQT_DBusDataConverter::convertFromDBusMessageIter<TQT_DBusObjectPath>(DBusMessageIter* iter, TQT_DBusObjectPath& typeData)
+{
+    const char* value = 0;
+    Result result = qReadBasic(iter, DBUS_TYPE_OBJECT_PATH, value);
+    if (result == Success) typeData = TQT_DBusObjectPath(TQString::fromUtf8(value));
+
+    return result;
+}
+
+template <>
+TQT_DBusDataConverter::Result TQT_DBusDataConverter::convertToDBusMessageIter<TQStringList>(const TQStringList& typeData, DBusMessageIter* iter)
+{
+    DBusMessageIter arrayIter;
+    if (!dbus_message_iter_open_container(iter, DBUS_TYPE_ARRAY,
+                                          DBUS_TYPE_STRING_AS_STRING, &arrayIter))
+        return InvalidArgument;
+
+    TQStringList::const_iterator it    = typeData.begin();
+    TQStringList::const_iterator endIt = typeData.end();
+    for (; it != endIt; ++it)
+    {
+        TQCString utf8 = (*it).utf8();
+        const char* value = utf8.data();
+        if (value == 0) value = "";
+
+        dbus_message_iter_append_basic(&arrayIter, DBUS_TYPE_STRING, &value);
+    }
+
+    if (!dbus_message_iter_close_container(iter, &arrayIter))
+        return InvalidArgument;
+
+    return Success;
+}
+
+template <>
+TQT_DBusDataConverter::Result TQT_DBusDataConverter::convertFromDBusMessageIter<TQStringList>(DBusMessageIter* iter, TQStringList& typeData)
+{
+    if (dbus_message_iter_get_arg_type(iter) != DBUS_TYPE_ARRAY ||
+        dbus_message_iter_get_element_type(iter) != DBUS_TYPE_STRING)
+        return InvalidSignature;
+
+    DBusMessageIter arrayIter;
+    dbus_message_iter_recurse(iter, &arrayIter);
+
+    typeData.clear();
+    while (dbus_message_iter_get_arg_type(&arrayIter) == DBUS_TYPE_STRING)
+    {
+        const char* value = 0;
+        dbus_message_iter_get_basic(&arrayIter, &value);
+        typeData.append(TQString::fromUtf8(value));
+
+        dbus_message_iter_next(&arrayIter);
+    }
+
+    return Success;
+}
+
+template <>
+TQT_DBusDataConverter::Result TQT_DBusDataConverter::convertToDBusMessageIter<TQPoint>(const TQPoint& typeData, DBusMessageIter* iter)
+{
+    dbus_int32_t values[2] = { typeData.x(), typeData.y() };
+    return qAppendInt32Struct(iter, values, 2);
+}
+
+template <>
+TQT_DBusDataConverter::Result TQT_DBusDataConverter::convertFromDBusMessageIter<TQPoint>(DBusMessageIter* iter, TQPoint& typeData)
+{
+    dbus_int32_t values[2];
+    Result result = qReadInt32Struct(iter, values, 2);
+    if (result == Success) typeData = TQPoint(values[0], values[1]);
+
+    return result;
+}
+
+template <>
+TQT_DBusDataConverter::Result TQT_DBusDataConverter::convertToDBusMessageIter<TQSize>(const TQSize& typeData, DBusMessageIter* iter)
+{
+    dbus_int32_t values[2] = { typeData.width(), typeData.height() };
+    return qAppendInt32Struct(iter, values, 2);
+}
+
+template <>
+TQT_DBusDataConverter::Result TQT_DBusDataConverter::convertFromDBusMessageIter<TQSize>(DBusMessageIter* iter, TQSize& typeData)
+{
+    dbus_int32_t values[2];
+    Result result = qReadInt32Struct(iter, values, 2);
+    if (result == Success) typeData = TQSize(values[0], values[1]);
+
+    return result;
+}
+
+template <>
+TQT_DBusDataConverter::Result TQT_DBusDataConverter::convertToDBusMessageIter<TQRect>(const TQRect& typeData, DBusMessageIter* iter)
+{
+    dbus_int32_t values[4] = { typeData.x(), typeData.y(), typeData.width(), typeData.height() };
+    return qAppendInt32Struct(iter, values, 4);
+}
+
+template <>
+TQT_DBusDataConverter::Result TQT_DBusDataConverter::convertFromDBusMessageIter<TQRect>(DBusMessageIter* iter, TQRect& typeData)
+{
+    dbus_int32_t values[4];
+    Result result = qReadInt32Struct(iter, values, 4);
+    if (result == Success) typeData = TQRect(values[0], values[1], values[2], values[3]);
+
+    return result;
+}
@@ -25,8 +25,16 @@
 #define TQDBUSDATACONVERTER_H
 
 #include "tqdbusmacros.h"
+#include "tqdbusdata.h"
 
-class TQT_DBusData;
+class TQPoint;
+class TQRect;
+class TQSize;
+class TQString;
+class TQStringList;
+class TQT_DBusObjectPath;
+
+struct DBusMessageIter;
 
 /**
  * @brief Template based converter for getting complex data into or from TQT_DBusData objects
@@ -202,6 +210,144 @@ public:
      */
     template <class T>
     static Result convertToTQT_DBusData(const T& typeData, TQT_DBusData& dbusData);
+
+    /**
+     * @brief Marshalls a native type directly into a D-Bus message
+     *
+     * Used by TQT_DBusMessage::append() to write the value without building
+     * a TQT_DBusData instance first.
+     *
+     * The library provides implementations for the basic types, i.e.
+     * @c bool, the integer types, @c double, TQString and
+     * TQT_DBusObjectPath, as well as for TQStringList and the types the
+     * TQT_DBusData conversions are implemented for: TQPoint, TQSize and TQRect.
+     *
+     * For any other type the value is converted with convertToTQT_DBusData()
+     * and then marshalled, so an implementation of this method is only
+     * needed to avoid that intermediate step.
+     *
+     * For example the implementation for TQPoint looks like this:
+     * @code
+     * template <>
+     * TQT_DBusDataConverter::Result
+     * TQT_DBusDataConverter::convertToDBusMessageIter<TQPoint>(const TQPoint& typeData, DBusMessageIter* iter)
+     * {
+     *     DBusMessageIter structIter;
+     *     if (!dbus_message_iter_open_container(iter, DBUS_TYPE_STRUCT, 0, &structIter))
+     *         return InvalidArgument;
+     *
+     *     dbus_int32_t x = typeData.x();
+     *     dbus_int32_t y = typeData.y();
+     *     dbus_message_iter_append_basic(&structIter, DBUS_TYPE_INT32, &x);
+     *     dbus_message_iter_append_basic(&structIter, DBUS_TYPE_INT32, &y);
+     *
+     *     dbus_message_iter_close_container(iter, &structIter);
+     *
+     *     return Success;
+     * }
+     * @endcode
+     *
+     * @param typeData the native type instance to get the content from
+     * @param iter the libdbus iterator to append the content to
+     *
+     * @return the conversion result value
+     */
+    template <class T>
+    static Result convertToDBusMessageIter(const T& typeData, DBusMessageIter* iter);
+
+    /**
+     * @brief De-marshalls a native type directly from a D-Bus message
+     *
+     * Used by TQT_DBusMessage::read() to get the value without building
+     * a TQT_DBusData instance first.
+     *
+     * See convertToDBusMessageIter() for the types implemented by the
+     * library. For any other type the value is de-marshalled into a
+     * TQT_DBusData instance and converted with convertFromTQT_DBusData().
+     *
+     * @param iter the libdbus iterator positioned at the value to read
+     * @param typeData the native type instance to put the content into
+     *
+     * @return the conversion result value
+     */
+    template <class T>
+    static Result convertFromDBusMessageIter(DBusMessageIter* iter, T& typeData);
+
+    /**
+     * @brief Marshalls a TQT_DBusData instance into a D-Bus message
+     *
+     * Fallback of convertToDBusMessageIter() for types without a direct
+     * implementation.
+     *
+     * @param dbusData the binding's data instance to get the content from
+     * @param iter the libdbus iterator to append the content to
+     *
+     * @return #InvalidArgument if @p dbusData is not valid, otherwise
+     *         #Success
+     */
+    static Result appendData(const TQT_DBusData& dbusData, DBusMessageIter* iter);
+
+    /**
+     * @brief De-marshalls a TQT_DBusData instance from a D-Bus message
+     *
+     * Fallback of convertFromDBusMessageIter() for types without a direct
+     * implementation.
+     *
+     * @param iter the libdbus iterator positioned at the value to read
+     * @param dbusData the binding's data instance to put the content into
+     *
+     * @return #InvalidSignature if the value could not be de-marshalled,
+     *         otherwise #Success
+     */
+    static Result readData(DBusMessageIter* iter, TQT_DBusData& dbusData);
 };
 
+template <class T>
+inline TQT_DBusDataConverter::Result
+TQT_DBusDataConverter::convertToDBusMessageIter(const T& typeData, DBusMessageIter* iter)
+{
+    TQT_DBusData dbusData;
+    Result result = convertToTQT_DBusData<T>(typeData, dbusData);
+    if (result != Success) return result;
+
+    return appendData(dbusData, iter);
+}
+
+template <class T>
+inline TQT_DBusDataConverter::Result
+TQT_DBusDataConverter::convertFromDBusMessageIter(DBusMessageIter* iter, T& typeData)
+{
+    TQT_DBusData dbusData;
+    Result result = readData(iter, dbusData);
+    if (result != Success) return result;
+
+    return convertFromTQT_DBusData<T>(dbusData, typeData);
+}
+
+// direct implementations, see tqdbusdataconverter.cpp
+
+#define TQDBUS_DECLARE_ITER_CONVERSION(Type) \
+template <> TQT_DBusDataConverter::Result \
+TQT_DBusDataConverter::convertToDBusMessageIter<Type>(const Type& typeData, DBusMessageIter* iter); \
+template <> TQT_DBusDataConverter::Result \
+TQT_DBusDataConverter::convertFromDBusMessageIter<Type>(DBusMessageIter* iter, Type& typeData)
+
+TQDBUS_DECLARE_ITER_CONVERSION(bool);
+TQDBUS_DECLARE_ITER_CONVERSION(TQ_UINT8);
+TQDBUS_DECLARE_ITER_CONVERSION(TQ_INT16);
+TQDBUS_DECLARE_ITER_CONVERSION(TQ_UINT16);
+TQDBUS_DECLARE_ITER_CONVERSION(TQ_INT32);
+TQDBUS_DECLARE_ITER_CONVERSION(TQ_UINT32);
+TQDBUS_DECLARE_ITER_CONVERSION(TQ_INT64);
+TQDBUS_DECLARE_ITER_CONVERSION(TQ_UINT64);
+TQDBUS_DECLARE_ITER_CONVERSION(double);
+TQDBUS_DECLARE_ITER_CONVERSION(TQString);
+TQDBUS_DECLARE_ITER_CONVERSION(TQT_DBusObjectPath);
+TQDBUS_DECLARE_ITER_CONVERSION(TQStringList);
+TQDBUS_DECLARE_ITER_CONVERSION(TQPoint);
+TQDBUS_DECLARE_ITER_CONVERSION(TQSize);
+TQDBUS_DECLARE_ITER_CONVERSION(TQRect);
+
+#undef TQDBUS_DECLARE_ITER_CONVERSION
+
 #endif
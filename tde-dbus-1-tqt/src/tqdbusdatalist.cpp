@@ -28,17 +28,147 @@
 
 #include <tqstringlist.h>
 
+#include <string.h>
+
+static uint qFixedElementSize(TQT_DBusData::Type type)
+{
+    switch (type)
+    {
+        case TQT_DBusData::Byte:
+            return 1;
+
+        case TQT_DBusData::Int16:  // fall through
+        case TQT_DBusData::UInt16:
+            return 2;
+
+        case TQT_DBusData::Bool:   // fall through, marshalled as 32-bit value
+        case TQT_DBusData::Int32:  // fall through
+        case TQT_DBusData::UInt32:
+            return 4;
+
+        case TQT_DBusData::Int64:  // fall through
+        case TQT_DBusData::UInt64: // fall through
+        case TQT_DBusData::Double:
+            return 8;
+
+        default:
+            return 0;
+    }
+}
+
+template <typename T>
+static TQByteArray qArrayToRaw(const TQMemArray<T>& array)
+{
+    TQByteArray raw;
+    raw.duplicate((const char*) array.data(), array.size() * sizeof(T));
+    return raw;
+}
+
+template <typename T>
+static TQMemArray<T> qRawToArray(const TQByteArray& raw)
+{
+    TQMemArray<T> array;
+    array.duplicate((const T*) raw.data(), raw.size() / sizeof(T));
+    return array;
+}
+
+template <typename T>
+static TQValueList<T> qRawToList(const TQByteArray& raw)
+{
+    const T* data = (const T*) raw.data();
+    const uint count = raw.size() / sizeof(T);
+
+    TQValueList<T> list;
+    for (uint i = 0; i < count; ++i)
+    {
+        list << data[i];
+    }
+    return list;
+}
+
 class TQT_DBusDataList::Private
 {
 public:
     Private() : type(TQT_DBusData::Invalid) {}
 
+    // converts contiguously stored elements into list items
+    void materialize();
+
+    // appends contiguously stored elements to target, leaves raw untouched
+    void appendRaw(TQValueList<TQT_DBusData>& target) const;
+
 public:
     TQT_DBusData::Type type;
     TQT_DBusData containerItem;
     TQValueList<TQT_DBusData> list;
+
+    // elements of fixed size types as one block, only used while list is empty
+    TQByteArray raw;
 };
 
+template <typename T>
+static void qAppendRaw(TQValueList<TQT_DBusData>& list, const TQByteArray& raw,
+                       TQT_DBusData (*convert)(T))
+{
+    const T* data = (const T*) raw.data();
+    const uint count = raw.size() / sizeof(T);
+    for (uint i = 0; i < count; ++i)
+    {
+        list << convert(data[i]);
+    }
+}
+
+static TQT_DBusData qBoolFromRaw(TQ_UINT32 value)
+{
+    return TQT_DBusData::fromBool(value != 0);
+}
+
+void TQT_DBusDataList::Private::materialize()
+{
+    if (raw.isEmpty()) return;
+
+    appendRaw(list);
+
+    // explicitly shared, so release instead of resizing
+    raw = TQByteArray();
+}
+
+void TQT_DBusDataList::Private::appendRaw(TQValueList<TQT_DBusData>& target) const
+{
+    switch (type)
+    {
+        case TQT_DBusData::Bool:
+            qAppendRaw<TQ_UINT32>(target, raw, qBoolFromRaw);
+            break;
+        case TQT_DBusData::Byte:
+            qAppendRaw<TQ_UINT8>(target, raw, TQT_DBusData::fromByte);
+            break;
+        case TQT_DBusData::Int16:
+            qAppendRaw<TQ_INT16>(target, raw, TQT_DBusData::fromInt16);
+            break;
+        case TQT_DBusData::UInt16:
+            qAppendRaw<TQ_UINT16>(target, raw, TQT_DBusData::fromUInt16);
+            break;
+        case TQT_DBusData::Int32:
+            qAppendRaw<TQ_INT32>(target, raw, TQT_DBusData::fromInt32);
+            break;
+        case TQT_DBusData::UInt32:
+            qAppendRaw<TQ_UINT32>(target, raw, TQT_DBusData::fromUInt32);
+            break;
+        case TQT_DBusData::Int64:
+            qAppendRaw<TQ_INT64>(target, raw, TQT_DBusData::fromInt64);
+            break;
+        case TQT_DBusData::UInt64:
+            qAppendRaw<TQ_UINT64>(target, raw, TQT_DBusData::fromUInt64);
+            break;
+        case TQT_DBusData::Double:
+            qAppendRaw<double>(target, raw, TQT_DBusData::fromDouble);
+            break;
+        default:
+            break;
+    }
+}
+
 TQT_DBusDataList::TQT_DBusDataList() : d(new Private())
 {
 }
@@ -70,6 +200,7 @@ TQT_DBusDataList::TQT_DBusDataList(const TQT_DBusDataList& other) : d(new Privat
     d->type = other.d->type;
     d->list = other.d->list;
     d->containerItem = other.d->containerItem;
+    d->raw = other.d->raw;
 }
 
 TQT_DBusDataList::TQT_DBusDataList(const TQValueList<TQT_DBusData>& other) : d(new Private())
@@ -81,11 +212,9 @@ TQT_DBusDataList::TQT_DBusDataList(const TQValueList<TQT_DBusData>& other) : d(n
 
     d->type = (*it).type();
 
-    TQCString elementSignature;
     if (hasContainerItemType())
     {
         d->containerItem = other[0]; // would be nice to get an empty one
-        elementSignature = d->containerItem.buildDBusSignature();
     }
 
     for (++it; it != endIt; ++it)
@@ -99,7 +228,7 @@ TQT_DBusDataList::TQT_DBusDataList(const TQValueList<TQT_DBusData>& other) : d(n
         }
         else if (hasContainerItemType())
         {
-            if ((*it).buildDBusSignature() != elementSignature)
+            if (!(*it).hasSameSignature(d->containerItem))
             {
                 d->type = TQT_DBusData::Invalid;
                 d->containerItem = TQT_DBusData();
@@ -297,6 +426,68 @@ TQT_DBusDataList::TQT_DBusDataList(const TQValueList<TQT_DBusUnixFd>& other)
     }
 }
 
+TQT_DBusDataList::TQT_DBusDataList(const TQMemArray<bool>& other) : d(new Private())
+{
+    d->type = TQT_DBusData::Bool;
+
+    // stored like D-Bus does, as 32-bit values
+    TQMemArray<TQ_UINT32> values(other.size());
+    for (uint i = 0; i < other.size(); ++i)
+    {
+        values[i] = other[i] ? 1 : 0;
+    }
+
+    d->raw = qArrayToRaw(values);
+}
+
+TQT_DBusDataList::TQT_DBusDataList(const TQByteArray& other) : d(new Private())
+{
+    d->type = TQT_DBusData::Byte;
+    d->raw.duplicate(other);
+}
+
+TQT_DBusDataList::TQT_DBusDataList(const TQMemArray<TQ_INT16>& other) : d(new Private())
+{
+    d->type = TQT_DBusData::Int16;
+    d->raw = qArrayToRaw(other);
+}
+
+TQT_DBusDataList::TQT_DBusDataList(const TQMemArray<TQ_UINT16>& other) : d(new Private())
+{
+    d->type = TQT_DBusData::UInt16;
+    d->raw = qArrayToRaw(other);
+}
+
+TQT_DBusDataList::TQT_DBusDataList(const TQMemArray<TQ_INT32>& other) : d(new Private())
+{
+    d->type = TQT_DBusData::Int32;
+    d->raw = qArrayToRaw(other);
+}
+
+TQT_DBusDataList::TQT_DBusDataList(const TQMemArray<TQ_UINT32>& other) : d(new Private())
+{
+    d->type = TQT_DBusData::UInt32;
+    d->raw = qArrayToRaw(other);
+}
+
+TQT_DBusDataList::TQT_DBusDataList(const TQMemArray<TQ_INT64>& other) : d(new Private())
+{
+    d->type = TQT_DBusData::Int64;
+    d->raw = qArrayToRaw(other);
+}
+
+TQT_DBusDataList::TQT_DBusDataList(const TQMemArray<TQ_UINT64>& other) : d(new Private())
+{
+    d->type = TQT_DBusData::UInt64;
+    d->raw = qArrayToRaw(other);
+}
+
+TQT_DBusDataList::TQT_DBusDataList(const TQMemArray<double>& other) : d(new Private())
+{
+    d->type = TQT_DBusData::Double;
+    d->raw = qArrayToRaw(other);
+}
+
 TQT_DBusDataList::~TQT_DBusDataList()
 {
     delete d;
@@ -309,6 +500,7 @@ TQT_DBusDataList& TQT_DBusDataList::operator=(const TQT_DBusDataList& other)
     d->type = other.d->type;
     d->list = other.d->list;
     d->containerItem = other.d->containerItem;
+    d->raw = other.d->raw;
 
     return *this;
 }
@@ -316,6 +508,7 @@ TQT_DBusDataList& TQT_DBusDataList::operator=(const TQT_DBusDataList& other)
 TQT_DBusDataList& TQT_DBusDataList::operator=(const TQValueList<TQT_DBusData>& other)
 {
     d->list.clear();
+    d->raw = TQByteArray();
     d->type = TQT_DBusData::Invalid;
     d->containerItem = TQT_DBusData();
 
@@ -326,12 +519,9 @@ TQT_DBusDataList& TQT_DBusDataList::operator=(const TQValueList<TQT_DBusData>& o
 
     d->type = (*it).type();
 
-    TQCString elementSignature;
     if (hasContainerItemType())
     {
         d->containerItem = other[0]; // would be nice to get an empty one
-
-        elementSignature = d->containerItem.buildDBusSignature();
     }
 
     for (++it; it != endIt; ++it)
@@ -345,7 +535,7 @@ TQT_DBusDataList& TQT_DBusDataList::operator=(const TQValueList<TQT_DBusData>& o
         }
         else if (hasContainerItemType())
         {
-            if ((*it).buildDBusSignature() != elementSignature)
+            if (!(*it).hasSameSignature(d->containerItem))
             {
                 d->type = TQT_DBusData::Invalid;
                 d->containerItem = TQT_DBusData();
@@ -363,6 +553,7 @@ TQT_DBusDataList& TQT_DBusDataList::operator=(const TQValueList<TQT_DBusData>& o
 TQT_DBusDataList& TQT_DBusDataList::operator=(const TQStringList& other)
 {
     d->list.clear();
+    d->raw = TQByteArray();
     d->type = TQT_DBusData::String;
     d->containerItem = TQT_DBusData();
 
@@ -394,11 +585,14 @@ TQT_DBusData TQT_DBusDataList::containerItemType() const
 
 bool TQT_DBusDataList::isEmpty() const
 {
-    return d->list.isEmpty();
+    return d->list.isEmpty() && d->raw.isEmpty();
 }
 
 uint TQT_DBusDataList::count() const
 {
+    if (!d->raw.isEmpty())
+        return d->raw.size() / qFixedElementSize(d->type);
+
     return d->list.count();
 }
 
@@ -407,13 +601,25 @@ bool TQT_DBusDataList::operator==(const TQT_DBusDataList& other) const
     if (&other == this) return true;
     if (d == other.d) return true;
 
+    if (d->type != other.d->type) return false;
+
+    // fixed size types have no container item, compare the element blocks
+    // without converting them into list items
+    if (qFixedElementSize(d->type) != 0)
+    {
+        const TQByteArray data      = fixedArrayData();
+        const TQByteArray otherData = other.fixedArrayData();
+
+        return data.size() == otherData.size() &&
+               memcmp(data.data(), otherData.data(), data.size()) == 0;
+    }
+
     bool containerEqual = true;
     if (hasContainerItemType())
     {
         if (other.hasContainerItemType())
         {
-            containerEqual = d->containerItem.buildDBusSignature() ==
-                             other.d->containerItem.buildDBusSignature();
+            containerEqual = d->containerItem.hasSameSignature(other.d->containerItem);
         }
         else
             containerEqual = false;
@@ -421,40 +627,26 @@ bool TQT_DBusDataList::operator==(const TQT_DBusDataList& other) const
     else if (other.hasContainerItemType())
         containerEqual = false;
 
-    return d->type == other.d->type && containerEqual && d->list == other.d->list;
+    return containerEqual && d->list == other.d->list;
 }
 
 bool TQT_DBusDataList::operator!=(const TQT_DBusDataList& other) const
 {
-    if (&other == this) return false;
-    if (d == other.d) return false;
-
-    bool containerEqual = true;
-    if (hasContainerItemType())
-    {
-        if (other.hasContainerItemType())
-        {
-            containerEqual = d->containerItem.buildDBusSignature() ==
-                             other.d->containerItem.buildDBusSignature();
-        }
-        else
-            containerEqual = false;
-    }
-    else if (other.hasContainerItemType())
-        containerEqual = false;
-
-    return d->type != other.d->type || !containerEqual || d->list != other.d->list;
+    return !(*this == other);
 }
 
 void TQT_DBusDataList::clear()
 {
     d->list.clear();
+    d->raw = TQByteArray();
 }
 
 TQT_DBusDataList& TQT_DBusDataList::operator<<(const TQT_DBusData& data)
 {
     if (data.type() == TQT_DBusData::Invalid) return *this;
 
+    d->materialize();
+
     if (d->type == TQT_DBusData::Invalid)
     {
         d->type = data.type();
@@ -471,14 +663,12 @@ TQT_DBusDataList& TQT_DBusDataList::operator<<(const TQT_DBusData& data)
     }
     else if (hasContainerItemType())
     {
-        TQCString ourSignature  = d->containerItem.buildDBusSignature();
-        TQCString dataSignature = data.buildDBusSignature();
-
-        if (ourSignature != dataSignature)
+        if (!data.hasSameSignature(d->containerItem))
         {
             tqWarning("TQT_DBusDataList: trying to add data with signature %s "
                      "to list with item signature %s",
-                     dataSignature.data(), ourSignature.data());
+                     data.buildDBusSignature().data(),
+                     d->containerItem.buildDBusSignature().data());
         }
         else
             d->list << data;
@@ -491,7 +681,12 @@ TQT_DBusDataList& TQT_DBusDataList::operator<<(const TQT_DBusData& data)
 
 TQValueList<TQT_DBusData> TQT_DBusDataList::toTQValueList() const
 {
-    return d->list;
+    if (d->raw.isEmpty()) return d->list;
+
+    TQValueList<TQT_DBusData> result;
+    d->appendRaw(result);
+
+    return result;
 }
 
 TQStringList TQT_DBusDataList::toTQStringList(bool* ok) const
@@ -526,6 +721,20 @@ TQValueList<bool> TQT_DBusDataList::toBoolList(bool* ok) const
 
     TQValueList<bool> result;
 
+    if (!d->raw.isEmpty())
+    {
+        // marshalled as 32-bit values
+        const TQ_UINT32* data = (const TQ_UINT32*) d->raw.data();
+        const uint count = d->raw.size() / sizeof(TQ_UINT32);
+        for (uint i = 0; i < count; ++i)
+        {
+            result << (data[i] != 0);
+        }
+
+        if (ok != 0) *ok = true;
+        return result;
+    }
+
     TQValueList<TQT_DBusData>::const_iterator it    = d->list.begin();
     TQValueList<TQT_DBusData>::const_iterator endIt = d->list.end();
     for (; it != endIt; ++it)
@@ -546,6 +755,12 @@ TQValueList<TQ_UINT8> TQT_DBusDataList::toByteList(bool* ok) const
         return TQValueList<TQ_UINT8>();
     }
 
+    if (!d->raw.isEmpty())
+    {
+        if (ok != 0) *ok = true;
+        return qRawToList<TQ_UINT8>(d->raw);
+    }
+
     TQValueList<TQ_UINT8> result;
 
     TQValueList<TQT_DBusData>::const_iterator it    = d->list.begin();
@@ -568,6 +783,12 @@ TQValueList<TQ_INT16> TQT_DBusDataList::toInt16List(bool* ok) const
         return TQValueList<TQ_INT16>();
     }
 
+    if (!d->raw.isEmpty())
+    {
+        if (ok != 0) *ok = true;
+        return qRawToList<TQ_INT16>(d->raw);
+    }
+
     TQValueList<TQ_INT16> result;
 
     TQValueList<TQT_DBusData>::const_iterator it    = d->list.begin();
@@ -590,6 +811,12 @@ TQValueList<TQ_UINT16> TQT_DBusDataList::toUInt16List(bool* ok) const
         return TQValueList<TQ_UINT16>();
     }
 
+    if (!d->raw.isEmpty())
+    {
+        if (ok != 0) *ok = true;
+        return qRawToList<TQ_UINT16>(d->raw);
+    }
+
     TQValueList<TQ_UINT16> result;
 
     TQValueList<TQT_DBusData>::const_iterator it    = d->list.begin();
@@ -612,6 +839,12 @@ TQValueList<TQ_INT32> TQT_DBusDataList::toInt32List(bool* ok) const
         return TQValueList<TQ_INT32>();
     }
 
+    if (!d->raw.isEmpty())
+    {
+        if (ok != 0) *ok = true;
+        return qRawToList<TQ_INT32>(d->raw);
+    }
+
     TQValueList<TQ_INT32> result;
 
     TQValueList<TQT_DBusData>::const_iterator it    = d->list.begin();
@@ -634,6 +867,12 @@ TQValueList<TQ_UINT32> TQT_DBusDataList::toUInt32List(bool* ok) const
         return TQValueList<TQ_UINT32>();
     }
 
+    if (!d->raw.isEmpty())
+    {
+        if (ok != 0) *ok = true;
+        return qRawToList<TQ_UINT32>(d->raw);
+    }
+
     TQValueList<TQ_UINT32> result;
 
     TQValueList<TQT_DBusData>::const_iterator it    = d->list.begin();
@@ -656,6 +895,12 @@ TQValueList<TQ_INT64> TQT_DBusDataList::toInt64List(bool* ok) const
         return TQValueList<TQ_INT64>();
     }
 
+    if (!d->raw.isEmpty())
+    {
+        if (ok != 0) *ok = true;
+        return qRawToList<TQ_INT64>(d->raw);
+    }
+
     TQValueList<TQ_INT64> result;
 
     TQValueList<TQT_DBusData>::const_iterator it    = d->list.begin();
@@ -678,6 +923,12 @@ TQValueList<TQ_UINT64> TQT_DBusDataList::toUInt64List(bool* ok) const
         return TQValueList<TQ_UINT64>();
     }
 
+    if (!d->raw.isEmpty())
+    {
+        if (ok != 0) *ok = true;
+        return qRawToList<TQ_UINT64>(d->raw);
+    }
+
     TQValueList<TQ_UINT64> result;
 
     TQValueList<TQT_DBusData>::const_iterator it    = d->list.begin();
@@ -700,6 +951,12 @@ TQValueList<double> TQT_DBusDataList::toDoubleList(bool* ok) const
         return TQValueList<double>();
     }
 
+    if (!d->raw.isEmpty())
+    {
+        if (ok != 0) *ok = true;
+        return qRawToList<double>(d->raw);
+    }
+
     TQValueList<double> result;
 
     TQValueList<TQT_DBusData>::const_iterator it    = d->list.begin();
@@ -784,3 +1041,221 @@ TQValueList<TQT_DBusVariant> TQT_DBusDataList::toVariantList(bool* ok) const
 
     return result;
 }
+
+TQMemArray<bool> TQT_DBusDataList::toBoolArray(bool* ok) const
+{
+    if (d->type != TQT_DBusData::Bool)
+    {
+        if (ok != 0) *ok = false;
+        return TQMemArray<bool>();
+    }
+
+    TQMemArray<TQ_UINT32> values = qRawToArray<TQ_UINT32>(fixedArrayData());
+
+    TQMemArray<bool> result(values.size());
+    for (uint i = 0; i < values.size(); ++i)
+    {
+        result[i] = values[i] != 0;
+    }
+
+    if (ok != 0) *ok = true;
+
+    return result;
+}
+
+TQByteArray TQT_DBusDataList::toByteArray(bool* ok) const
+{
+    if (d->type != TQT_DBusData::Byte)
+    {
+        if (ok != 0) *ok = false;
+        return TQByteArray();
+    }
+
+    if (ok != 0) *ok = true;
+
+    return qRawToArray<char>(fixedArrayData());
+}
+
+TQMemArray<TQ_INT16> TQT_DBusDataList::toInt16Array(bool* ok) const
+{
+    if (d->type != TQT_DBusData::Int16)
+    {
+        if (ok != 0) *ok = false;
+        return TQMemArray<TQ_INT16>();
+    }
+
+    if (ok != 0) *ok = true;
+
+    return qRawToArray<TQ_INT16>(fixedArrayData());
+}
+
+TQMemArray<TQ_UINT16> TQT_DBusDataList::toUInt16Array(bool* ok) const
+{
+    if (d->type != TQT_DBusData::UInt16)
+    {
+        if (ok != 0) *ok = false;
+        return TQMemArray<TQ_UINT16>();
+    }
+
+    if (ok != 0) *ok = true;
+
+    return qRawToArray<TQ_UINT16>(fixedArrayData());
+}
+
+TQMemArray<TQ_INT32> TQT_DBusDataList::toInt32Array(bool* ok) const
+{
+    if (d->type != TQT_DBusData::Int32)
+    {
+        if (ok != 0) *ok = false;
+        return TQMemArray<TQ_INT32>();
+    }
+
+    if (ok != 0) *ok = true;
+
+    return qRawToArray<TQ_INT32>(fixedArrayData());
+}
+
+TQMemArray<TQ_UINT32> TQT_DBusDataList::toUInt32Array(bool* ok) const
+{
+    if (d->type != TQT_DBusData::UInt32)
+    {
+        if (ok != 0) *ok = false;
+        return TQMemArray<TQ_UINT32>();
+    }
+
+    if (ok != 0) *ok = true;
+
+    return qRawToArray<TQ_UINT32>(fixedArrayData());
+}
+
+TQMemArray<TQ_INT64> TQT_DBusDataList::toInt64Array(bool* ok) const
+{
+    if (d->type != TQT_DBusData::Int64)
+    {
+        if (ok != 0) *ok = false;
+        return TQMemArray<TQ_INT64>();
+    }
+
+    if (ok != 0) *ok = true;
+
+    return qRawToArray<TQ_INT64>(fixedArrayData());
+}
+
+TQMemArray<TQ_UINT64> TQT_DBusDataList::toUInt64Array(bool* ok) const
+{
+    if (d->type != TQT_DBusData::UInt64)
+    {
+        if (ok != 0) *ok = false;
+        return TQMemArray<TQ_UINT64>();
+    }
+
+    if (ok != 0) *ok = true;
+
+    return qRawToArray<TQ_UINT64>(fixedArrayData());
+}
+
+TQMemArray<double> TQT_DBusDataList::toDoubleArray(bool* ok) const
+{
+    if (d->type != TQT_DBusData::Double)
+    {
+        if (ok != 0) *ok = false;
+        return TQMemArray<double>();
+    }
+
+    if (ok != 0) *ok = true;
+
+    return qRawToArray<double>(fixedArrayData());
+}
+
+TQByteArray TQT_DBusDataList::fixedArrayData() const
+{
+    const uint elementSize = qFixedElementSize(d->type);
+    if (elementSize == 0) return TQByteArray();
+
+    if (!d->raw.isEmpty()) return d->raw;
+
+    TQByteArray result(d->list.count() * elementSize);
+    char* data = result.data();
+
+    TQValueList<TQT_DBusData>::const_iterator it    = d->list.begin();
+    TQValueList<TQT_DBusData>::const_iterator endIt = d->list.end();
+    for (; it != endIt; ++it, data += elementSize)
+    {
+        switch (d->type)
+        {
+            case TQT_DBusData::Bool: {
+                TQ_UINT32 value = (*it).toBool() ? 1 : 0;
+                memcpy(data, &value, elementSize);
+                break;
+            }
+            case TQT_DBusData::Byte: {
+                TQ_UINT8 value = (*it).toByte();
+                memcpy(data, &value, elementSize);
+                break;
+            }
+            case TQT_DBusData::Int16: {
+                TQ_INT16 value = (*it).toInt16();
+                memcpy(data, &value, elementSize);
+                break;
+            }
+            case TQT_DBusData::UInt16: {
+                TQ_UINT16 value = (*it).toUInt16();
+                memcpy(data, &value, elementSize);
+                break;
+            }
+            case TQT_DBusData::Int32: {
+                TQ_INT32 value = (*it).toInt32();
+                memcpy(data, &value, elementSize);
+                break;
+            }
+            case TQT_DBusData::UInt32: {
+                TQ_UINT32 value = (*it).toUInt32();
+                memcpy(data, &value, elementSize);
+                break;
+            }
+            case TQT_DBusData::Int64: {
+                TQ_INT64 value = (*it).toInt64();
+                memcpy(data, &value, elementSize);
+                break;
+            }
+            case TQT_DBusData::UInt64: {
+                TQ_UINT64 value = (*it).toUInt64();
+                memcpy(data, &value, elementSize);
+                break;
+            }
+            case TQT_DBusData::Double: {
+                double value = (*it).toDouble();
+                memcpy(data, &value, elementSize);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    return result;
+}
+
+TQT_DBusDataList TQT_DBusDataList::fromFixedArray(TQT_DBusData::Type type,
+                                                  const void* data, int count)
+{
+    TQT_DBusDataList list(type);
+
+    const uint elementSize = qFixedElementSize(type);
+    if (elementSize == 0 || data == 0 || count <= 0) return list;
+
+    list.d->raw.duplicate((const char*) data, count * elementSize);
+
+    return list;
+}
+
+TQT_DBusDataList TQT_DBusDataList::deepCopy() const
+{
+    TQT_DBusDataList copy(*this);
+
+    // detaching copies the elements. Fixed size elements kept as one block
+    // do not refer to anything else and can stay shared
+    copy.d->list.begin();
+
+    return copy;
+}
@@ -26,12 +26,16 @@
 
 #include "tqdbusdata.h"
 
+#include <tqcstring.h>
+#include <tqmemarray.h>
+
 template <typename T> class TQValueList;
 class TQT_DBusObjectPath;
 class TQT_DBusVariant;
 class TQT_DBusUnixFd;
 class TQString;
 class TQStringList;
+class TQT_DBusMarshall;
 
 /**
  * @brief Class to transport lists of D-Bus data types
@@ -66,10 +70,25 @@ class TQStringList;
  * TQT_DBusDataList outerList(elementType);
  * @endcode
  *
+ * Lists of fixed size types, i.e. TQT_DBusData::Bool, TQT_DBusData::Byte,
+ * the integer types and TQT_DBusData::Double, can also be created from and
+ * converted to contiguous arrays, e.g. TQByteArray or TQMemArray<TQ_INT32>.
+ * Such lists keep their elements in one block of memory which is
+ * marshalled and de-marshalled as a whole, without creating a TQT_DBusData
+ * object per element.
+ * @code
+ * TQByteArray blob = file.readAll();
+ *
+ * TQT_DBusData data = TQT_DBusData::fromList(TQT_DBusDataList(blob));
+ * @endcode
+ *
  * @see TQT_DBusDataMap
  */
 class TQDBUS_EXPORT TQT_DBusDataList
 {
+    friend class TQT_DBusData;
+    friend class TQT_DBusMarshall;
+
 public:
     /**
      * @brief Creates an empty and invalid list
@@ -313,6 +332,108 @@ public:
      */
     TQT_DBusDataList(const TQValueList<TQT_DBusUnixFd>& other);
 
+    /**
+     * @brief Creates a list from the given array of boolean values
+     *
+     * Type information for the list object will be set to TQT_DBusData::Bool.
+     * The values are stored contiguously, see toBoolArray()
+     *
+     * @param other the array of boolean values to copy from
+     *
+     * @see toBoolArray()
+     */
+    explicit TQT_DBusDataList(const TQMemArray<bool>& other);
+
+    /**
+     * @brief Creates a list from the given array of bytes
+     *
+     * Type information for the list object will be set to TQT_DBusData::Byte.
+     * The bytes are copied into one contiguous block which is marshalled
+     * as a whole, i.e. this is the efficient way to transport binary data
+     *
+     * @param other the array of bytes to copy from
+     *
+     * @see toByteArray()
+     */
+    explicit TQT_DBusDataList(const TQByteArray& other);
+
+    /**
+     * @brief Creates a list from the given array of signed 16-bit integer values
+     *
+     * Type information for the list object will be set to TQT_DBusData::Int16.
+     *
+     * @param other the array of signed 16-bit integer values to copy from
+     *
+     * @see toInt16Array()
+     */
+    explicit TQT_DBusDataList(const TQMemArray<TQ_INT16>& other);
+
+    /**
+     * @brief Creates a list from the given array of unsigned 16-bit integer values
+     *
+     * Type information for the list object will be set to TQT_DBusData::UInt16.
+     *
+     * @param other the array of unsigned 16-bit integer values to copy from
+     *
+     * @see toUInt16Array()
+     */
+    explicit TQT_DBusDataList(const TQMemArray<TQ_UINT16>& other);
+
+    /**
+     * @brief Creates a list from the given array of signed 32-bit integer values
+     *
+     * Type information for the list object will be set to TQT_DBusData::Int32.
+     *
+     * @param other the array of signed 32-bit integer values to copy from
+     *
+     * @see toInt32Array()
+     */
+    explicit TQT_DBusDataList(const TQMemArray<TQ_INT32>& other);
+
+    /**
+     * @brief Creates a list from the given array of unsigned 32-bit integer values
+     *
+     * Type information for the list object will be set to TQT_DBusData::UInt32.
+     *
+     * @param other the array of unsigned 32-bit integer values to copy from
+     *
+     * @see toUInt32Array()
+     */
+    explicit TQT_DBusDataList(const TQMemArray<TQ_UINT32>& other);
+
+    /**
+     * @brief Creates a list from the given array of signed 64-bit integer values
+     *
+     * Type information for the list object will be set to TQT_DBusData::Int64.
+     *
+     * @param other the array of signed 64-bit integer values to copy from
+     *
+     * @see toInt64Array()
+     */
+    explicit TQT_DBusDataList(const TQMemArray<TQ_INT64>& other);
+
+    /**
+     * @brief Creates a list from the given array of unsigned 64-bit integer values
+     *
+     * Type information for the list object will be set to TQT_DBusData::UInt64.
+     *
+     * @param other the array of unsigned 64-bit integer values to copy from
+     *
+     * @see toUInt64Array()
+     */
+    explicit TQT_DBusDataList(const TQMemArray<TQ_UINT64>& other);
+
+    /**
+     * @brief Creates a list from the given array of double values
+     *
+     * Type information for the list object will be set to TQT_DBusData::Double.
+     *
+     * @param other the array of double values to copy from
+     *
+     * @see toDoubleArray()
+     */
+    explicit TQT_DBusDataList(const TQMemArray<double>& other);
+
     /**
      * @brief Destroys the list object
      */
@@ -750,6 +871,155 @@ public:
      */
     TQValueList<TQT_DBusUnixFd> toUnixFdList(bool* ok = 0) const;
 
+    /**
+     * @brief Tries to get the list object's elements as an array of bool
+     *
+     * @param ok optional pointer to a bool variable to store the
+     *        success information in, i.e. will be set to @c true on success
+     *        and to @c false if the conversion failed (not of type
+     *        TQT_DBusData::Bool)
+     *
+     * @return an array containing the list object's boolean elements or an
+     *         empty array when converting fails
+     *
+     * @see toBoolList()
+     */
+    TQMemArray<bool> toBoolArray(bool* ok = 0) const;
+
+    /**
+     * @brief Tries to get the list object's elements as a byte array
+     *
+     * Unlike toByteList() this does not need to handle each element
+     * separately if the list has been created from or de-marshalled into
+     * a contiguous array.
+     *
+     * @param ok optional pointer to a bool variable to store the
+     *        success information in, i.e. will be set to @c true on success
+     *        and to @c false if the conversion failed (not of type
+     *        TQT_DBusData::Byte)
+     *
+     * @return a TQByteArray containing the list object's byte elements or an
+     *         empty array when converting fails
+     *
+     * @see toByteList()
+     */
+    TQByteArray toByteArray(bool* ok = 0) const;
+
+    /**
+     * @brief Tries to get the list object's elements as an array of TQ_INT16
+     *
+     * @param ok optional pointer to a bool variable to store the
+     *        success information in, i.e. will be set to @c true on success
+     *        and to @c false if the conversion failed (not of type
+     *        TQT_DBusData::Int16)
+     *
+     * @return an array containing the list object's signed 16-bit integer
+     *         elements or an empty array when converting fails
+     *
+     * @see toInt16List()
+     */
+    TQMemArray<TQ_INT16> toInt16Array(bool* ok = 0) const;
+
+    /**
+     * @brief Tries to get the list object's elements as an array of TQ_UINT16
+     *
+     * @param ok optional pointer to a bool variable to store the
+     *        success information in, i.e. will be set to @c true on success
+     *        and to @c false if the conversion failed (not of type
+     *        TQT_DBusData::UInt16)
+     *
+     * @return an array containing the list object's unsigned 16-bit integer
+     *         elements or an empty array when converting fails
+     *
+     * @see toUInt16List()
+     */
+    TQMemArray<TQ_UINT16> toUInt16Array(bool* ok = 0) const;
+
+    /**
+     * @brief Tries to get the list object's elements as an array of TQ_INT32
+     *
+     * @param ok optional pointer to a bool variable to store the
+     *        success information in, i.e. will be set to @c true on success
+     *        and to @c false if the conversion failed (not of type
+     *        TQT_DBusData::Int32)
+     *
+     * @return an array containing the list object's signed 32-bit integer
+     *         elements or an empty array when converting fails
+     *
+     * @see toInt32List()
+     */
+    TQMemArray<TQ_INT32> toInt32Array(bool* ok = 0) const;
+
+    /**
+     * @brief Tries to get the list object's elements as an array of TQ_UINT32
+     *
+     * @param ok optional pointer to a bool variable to store the
+     *        success information in, i.e. will be set to @c true on success
+     *        and to @c false if the conversion failed (not of type
+     *        TQT_DBusData::UInt32)
+     *
+     * @return an array containing the list object's unsigned 32-bit integer
+     *         elements or an empty array when converting fails
+     *
+     * @see toUInt32List()
+     */
+    TQMemArray<TQ_UINT32> toUInt32Array(bool* ok = 0) const;
+
+    /**
+     * @brief Tries to get the list object's elements as an array of TQ_INT64
+     *
+     * @param ok optional pointer to a bool variable to store the
+     *        success information in, i.e. will be set to @c true on success
+     *        and to @c false if the conversion failed (not of type
+     *        TQT_DBusData::Int64)
+     *
+     * @return an array containing the list object's signed 64-bit integer
+     *         elements or an empty array when converting fails
+     *
+     * @see toInt64List()
+     */
+    TQMemArray<TQ_INT64> toInt64Array(bool* ok = 0) const;
+
+    /**
+     * @brief Tries to get the list object's elements as an array of TQ_UINT64
+     *
+     * @param ok optional pointer to a bool variable to store the
+     *        success information in, i.e. will be set to @c true on success
+     *        and to @c false if the conversion failed (not of type
+     *        TQT_DBusData::UInt64)
+     *
+     * @return an array containing the list object's unsigned 64-bit integer
+     *         elements or an empty array when converting fails
+     *
+     * @see toUInt64List()
+     */
+    TQMemArray<TQ_UINT64> toUInt64Array(bool* ok = 0) const;
+
+    /**
+     * @brief Tries to get the list object's elements as an array of double
+     *
+     * @param ok optional pointer to a bool variable to store the
+     *        success information in, i.e. will be set to @c true on success
+     *        and to @c false if the conversion failed (not of type
+     *        TQT_DBusData::Double)
+     *
+     * @return an array containing the list object's double elements or an
+     *         empty array when converting fails
+     *
+     * @see toDoubleList()
+     */
+    TQMemArray<double> toDoubleArray(bool* ok = 0) const;
+
+private:
+    // contiguous elements of fixed size types in D-Bus layout (booleans as
+    // 32-bit values) or a null array for other types
+    TQByteArray fixedArrayData() const;
+    static TQT_DBusDataList fromFixedArray(TQT_DBusData::Type type,
+                                           const void* data, int count);
+
+    // copy which does not share its elements with this list
+    TQT_DBusDataList deepCopy() const;
+
 private:
     class Private;
     Private* d;
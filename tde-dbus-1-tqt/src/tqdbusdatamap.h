@@ -155,11 +155,9 @@ public:
 
         m_valueType = (*it).type();
 
-        TQCString containerSignature;
         if (hasContainerValueType())
         {
             m_containerValueType = it.data();
-            containerSignature = m_containerValueType.buildDBusSignature();
         }
 
         for (++it; it != end(); ++it)
@@ -174,7 +172,7 @@ public:
             }
             else if (hasContainerValueType())
             {
-                if (it.data().buildDBusSignature() != containerSignature)
+                if (!it.data().hasSameSignature(m_containerValueType))
                 {
                     m_valueType = TQT_DBusData::Invalid;
                     m_containerValueType = TQT_DBusData();
@@ -691,11 +689,9 @@ public:
 
         m_valueType = (*it).type();
 
-        TQCString containerSignature;
         if (hasContainerValueType())
         {
             m_containerValueType = it.data();
-            containerSignature = m_containerValueType.buildDBusSignature();
         }
 
         for (++it; it != end(); ++it)
@@ -710,7 +706,7 @@ public:
             }
             else if (hasContainerValueType())
             {
-                if (it.data()->buildSignature() != containerSignature)
+                if (!it.data().hasSameSignature(m_containerValueType))
                 {
                     m_valueType = TQT_DBusData::Invalid;
                     m_containerValueType = TQT_DBusData();
@@ -831,8 +827,8 @@ public:
 
         if (hasContainerValueType())
         {
-            if (m_containerValueType.buildDBusSignature() !=
-                other.m_containerValueType.buildDBusSignature()) return false;
+            if (!m_containerValueType.hasSameSignature(other.m_containerValueType))
+                return false;
         }
 
         const_iterator it = begin();
@@ -912,14 +908,12 @@ public:
         }
         else if (hasContainerValueType())
         {
-            TQCString ourSignature  = m_containerValueType.buildDBusSignature();
-            TQCString dataSignature = data.buildDBusSignature();
-
-            if (ourSignature != dataSignature)
+            if (!data.hasSameSignature(m_containerValueType))
             {
                 tqWarning("TQT_DBusDataMap: trying to add data with signature %s "
                         "to map with value signature %s",
-                        dataSignature.data(), ourSignature.data());
+                        data.buildDBusSignature().data(),
+                        m_containerValueType.buildDBusSignature().data());
             }
             else
                 TQMap<T, TQT_DBusData>::insert(key, data);
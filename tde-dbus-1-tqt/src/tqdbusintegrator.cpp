@@ -22,29 +22,25 @@
  *
  */
 
+#include <unistd.h>
+
 #include <tqapplication.h>
 #include <tqevent.h>
+#include <tqeventloop.h>
 #include <tqmetaobject.h>
+#include <tqptrlist.h>
 #include <tqsocketnotifier.h>
+#include <tqstringlist.h>
 #include <tqtimer.h>
 
+#include <private/tqucom_p.h>
+
 #include "tqdbusconnection_p.h"
+#include "tqdbusdatalist.h"
+#include "tqdbusdatamap.h"
+#include "tqdbusiothread_p.h"
 #include "tqdbusmessage.h"
-
-Atomic::Atomic(int value) : m_value(value)
-{
-}
-
-void Atomic::ref()
-{
-    m_value++;
-}
-
-bool Atomic::deref()
-{
-    m_value--;
-    return m_value > 0;
-}
+#include "tqdbusworkerpool_p.h"
 
 int TQT_DBusConnectionPrivate::messageMetaType = 0;
 
@@ -68,7 +64,9 @@ static dbus_bool_t qDBusAddTimeout(DBusTimeout *timeout, void *data)
     if (!timerId)
         return false;
 
+    d->timeoutMutex.lock();
     d->timeouts[timerId] = timeout;
+    d->timeoutMutex.unlock();
     return true;
 }
 
@@ -89,10 +87,16 @@ static void qDBusRemoveTimeout(DBusTimeout *timeout, void *data)
         ++it;
     }
 
+    // timers can only be killed by the GUI thread. Off that thread only the
+    // mapping is removed, timerEvent() kills timers without one
+    const bool killTimers = TQThread::currentThread() == d->mainThread;
+
+    d->timeoutMutex.lock();
     TQT_DBusConnectionPrivate::TimeoutHash::iterator it = d->timeouts.begin();
     while (it != d->timeouts.end()) {
         if (it.data() == timeout) {
-            d->killTimer(it.key());
+            if (killTimers)
+                d->killTimer(it.key());
             TQT_DBusConnectionPrivate::TimeoutHash::iterator copyIt = it;
             ++it;
             d->timeouts.erase(copyIt);
@@ -100,6 +104,7 @@ static void qDBusRemoveTimeout(DBusTimeout *timeout, void *data)
             ++it;
         }
     }
+    d->timeoutMutex.unlock();
 }
 
 static void qDBusToggleTimeout(DBusTimeout *timeout, void *data)
@@ -231,6 +236,14 @@ static void qDBusToggleWatch(DBusWatch *watch, void *data)
     }
 }
 
+static void qDBusWakeUpIOThread(void *data)
+{
+    Q_ASSERT(data);
+
+    // a message has been queued for sending
+    static_cast<TQT_DBusIOThread *>(data)->wakeUp();
+}
+
 static void qDBusNewConnection(DBusServer *server, DBusConnection *c, void *data)
 {
     Q_ASSERT(data); Q_ASSERT(server); Q_ASSERT(c);
@@ -273,13 +286,27 @@ int TQT_DBusConnectionPrivate::registerMessageMetaType()
 
 TQT_DBusConnectionPrivate::TQT_DBusConnectionPrivate(TQObject *parent)
     : TQObject(parent), ref(1), mode(InvalidMode), connection(0), server(0),
-      dispatcher(0), inDispatch(false)
+      dispatcher(0), ioThread(0), workerPool(0), coalescePropertiesChanged(false),
+      defaultTimeout(TQT_DBusMessage::DefaultTimeout), timedOutCalls(0),
+      processEventsDuringCalls(false), inDispatch(false)
 {
     static const int msgType = registerMessageMetaType();
     Q_UNUSED(msgType);
 
     dbus_error_init(&error);
 
+    mainThread = TQThread::currentThread();
+
+    registeredObjects.resize(127);
+    registeredTrees.resize(17);
+
+    signalHooks.resize(127);
+    signalHooks.setAutoDelete(true);
+    for (int i = 0; i < 16; ++i)
+        hookPatterns[i] = 0;
+
+    batchHooks.setAutoDelete(true);
+
     dispatcher = new TQTimer(this);
     TQObject::connect(dispatcher, TQ_SIGNAL(timeout()), this, TQ_SLOT(dispatch()));
 
@@ -300,6 +327,7 @@ TQT_DBusConnectionPrivate::~TQT_DBusConnectionPrivate()
         delete copyIt.data();
         pendingCalls.erase(copyIt);
     }
+    trackedReceivers.clear();
 
     if (dbus_error_is_set(&error))
         dbus_error_free(&error);
@@ -309,6 +337,26 @@ TQT_DBusConnectionPrivate::~TQT_DBusConnectionPrivate()
 
 void TQT_DBusConnectionPrivate::closeConnection()
 {
+    // waits for running method calls, they might still send replies
+    delete workerPool;
+    workerPool = 0;
+
+    stopIOThread();
+
+    outgoingMutex.lock();
+    TQValueList<DBusMessage*> messages = outgoingMessages;
+    outgoingMessages.clear();
+    outgoingMutex.unlock();
+
+    TQValueList<DBusMessage*>::const_iterator it    = messages.begin();
+    TQValueList<DBusMessage*>::const_iterator endIt = messages.end();
+    for (; it != endIt; ++it)
+    {
+        if (connection != 0)
+            dbus_connection_send(connection, *it, 0);
+        dbus_message_unref(*it);
+    }
+
     ConnectionMode oldMode = mode;
     mode = InvalidMode; // prevent reentrancy
     if (oldMode == ServerMode) {
@@ -329,6 +377,171 @@ void TQT_DBusConnectionPrivate::closeConnection()
             connection = 0;
         }
     }
+
+    headerStrings.clear();
+}
+
+bool TQT_DBusConnectionPrivate::startIOThread()
+{
+    if (ioThread != 0) return true;
+
+    if (mode != ClientMode || connection == 0 || tqApp == 0)
+        return false;
+
+    // a no-op unless thread support failed when the connection was created
+    if (!dbus_threads_init_default())
+        return false;
+
+    TQT_DBusIOThread* thread = new TQT_DBusIOThread(this, connection);
+    if (!thread->isValid())
+    {
+        delete thread;
+        return false;
+    }
+
+    // the thread does all socket I/O from now on, which also removes the
+    // socket notifiers of the watches
+    dbus_connection_set_watch_functions(connection, 0, 0, 0, 0, 0);
+    dbus_connection_set_wakeup_main_function(connection, qDBusWakeUpIOThread, thread, 0);
+
+    ioThread = thread;
+    ioThread->start();
+
+    // messages might have been read before
+    scheduleDispatch();
+
+    return true;
+}
+
+void TQT_DBusConnectionPrivate::stopIOThread()
+{
+    if (ioThread == 0) return;
+
+    ioThread->stop();
+
+    if (connection != 0)
+    {
+        dbus_connection_set_wakeup_main_function(connection, 0, 0, 0);
+        dbus_connection_set_watch_functions(connection, qDBusAddWatch, qDBusRemoveWatch,
+                                            qDBusToggleWatch, this, 0);
+    }
+
+    delete ioThread;
+    ioThread = 0;
+
+    if (mode == ClientMode)
+        scheduleDispatch();
+}
+
+bool TQT_DBusConnectionPrivate::sendFromAnyThread(DBusMessage* message)
+{
+    // while there is no I/O thread, libdbus toggles our socket notifiers
+    // from the sending thread, which must thus be the GUI thread
+    if (ioThread != 0 || TQThread::currentThread() == mainThread)
+        return connection != 0 && dbus_connection_send(connection, message, 0);
+
+    outgoingMutex.lock();
+    bool post = outgoingMessages.isEmpty();
+    outgoingMessages.append(dbus_message_ref(message));
+    outgoingMutex.unlock();
+
+    if (post)
+        TQApplication::postEvent(this, new TQCustomEvent(SendEvent));
+
+    return true;
+}
+
+bool TQT_DBusConnectionPrivate::callObject(TQT_DBusObjectBase* object,
+                                          const TQT_DBusMessage& message)
+{
+    return object->handleMethodCall(message);
+}
+
+bool TQT_DBusConnectionPrivate::setObjectConcurrency(TQT_DBusObjectBase* object, uint maxCalls)
+{
+    if (workerPool == 0)
+    {
+        if (maxCalls == 0) return true;
+
+        if (mode != ClientMode || tqApp == 0 || !dbus_threads_init_default())
+            return false;
+
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        uint threads = cpus < 2 ? 2 : (cpus > 16 ? 16 : (uint) cpus);
+
+        workerPool = new TQT_DBusWorkerPool(this, threads);
+    }
+
+    workerPool->setConcurrency(object, maxCalls);
+    return true;
+}
+
+void TQT_DBusConnectionPrivate::releaseObject(TQT_DBusObjectBase* object)
+{
+    if (workerPool == 0 || object == 0) return;
+
+    // still reachable through another path, keep its concurrency setting
+    TQDictIterator<TQT_DBusObjectBase> objectIt(registeredObjects);
+    for (; objectIt.current() != 0; ++objectIt)
+    {
+        if (objectIt.current() == object)
+        {
+            workerPool->drain(object);
+            return;
+        }
+    }
+
+    TQDictIterator<TQT_DBusObjectBase> treeIt(registeredTrees);
+    for (; treeIt.current() != 0; ++treeIt)
+    {
+        if (treeIt.current() == object)
+        {
+            workerPool->drain(object);
+            return;
+        }
+    }
+
+    // drains the object's calls and forgets about it
+    workerPool->setConcurrency(object, 0);
+}
+
+void TQT_DBusConnectionPrivate::customEvent(TQCustomEvent *e)
+{
+    if (e->type() == SendEvent)
+    {
+        outgoingMutex.lock();
+        TQValueList<DBusMessage*> messages = outgoingMessages;
+        outgoingMessages.clear();
+        outgoingMutex.unlock();
+
+        TQValueList<DBusMessage*>::const_iterator it    = messages.begin();
+        TQValueList<DBusMessage*>::const_iterator endIt = messages.end();
+        for (; it != endIt; ++it)
+        {
+            if (connection != 0)
+                dbus_connection_send(connection, *it, 0);
+            dbus_message_unref(*it);
+        }
+        return;
+    }
+
+    if (e->type() != TQT_DBusIOThread::DispatchEvent || ioThread == 0)
+        return;
+
+    // allow the thread to post again for messages read from now on
+    ioThread->dispatched();
+
+    if (inDispatch)
+    {
+        scheduleDispatch();
+        return;
+    }
+
+    while (mode == ClientMode && !inDispatch &&
+           dbus_connection_get_dispatch_status(connection) == DBUS_DISPATCH_DATA_REMAINS)
+    {
+        dispatch();
+    }
 }
 
 bool TQT_DBusConnectionPrivate::handleError()
@@ -339,6 +552,81 @@ bool TQT_DBusConnectionPrivate::handleError()
     return lastError.isValid();
 }
 
+int TQT_DBusConnectionPrivate::callTimeout(const TQT_DBusMessage& message) const
+{
+    // TQT_DBusMessage::NoTimeout has the same value as DBUS_TIMEOUT_INFINITE
+    // and TQT_DBusMessage::DefaultTimeout as DBUS_TIMEOUT_USE_DEFAULT
+    if (message.timeout() != TQT_DBusMessage::DefaultTimeout)
+        return message.timeout();
+
+    return defaultTimeout;
+}
+
+void TQT_DBusConnectionPrivate::checkTimedOut(const TQT_DBusError& error)
+{
+    // libdbus reports an expired pending call as NoReply
+    if (error.type() == TQT_DBusError::NoReply || error.type() == TQT_DBusError::Timeout)
+        ++timedOutCalls;
+}
+
+bool TQT_DBusConnectionPrivate::canProcessEventsDuringCall() const
+{
+    // dbus_connection_dispatch() cannot be entered again from within one of
+    // our libdbus callbacks, so the reply could never be dispatched there
+    return processEventsDuringCalls && !inDispatch && mode == ClientMode && tqApp != 0;
+}
+
+DBusMessage* TQT_DBusConnectionPrivate::sendWithReplyAndProcessEvents(DBusMessage* msg,
+                                                                    int timeout)
+{
+    DBusPendingCall* pending = 0;
+    if (!dbus_connection_send_with_reply(connection, msg, &pending, timeout) || pending == 0)
+    {
+        dbus_set_error_const(&error, DBUS_ERROR_DISCONNECTED,
+                             "Connection is closed");
+        return 0;
+    }
+
+    {
+        TQT_DBusBlockingCall blocking(ioThread);
+        dbus_connection_flush(connection);
+    }
+
+    // the socket notifiers read the reply and dispatch() completes the
+    // pending call with it. If the timeout expires first, libdbus completes
+    // it with a NoReply error through the timers registered with us
+    DBusConnection* conn = connection;
+    while (!dbus_pending_call_get_completed(pending))
+    {
+        if (conn != connection || !dbus_connection_get_is_connected(conn))
+            break;
+
+        tqApp->eventLoop()->processEvents(TQEventLoop::ExcludeUserInput |
+                                          TQEventLoop::WaitForMore);
+    }
+
+    DBusMessage* reply = 0;
+    if (dbus_pending_call_get_completed(pending))
+    {
+        reply = dbus_pending_call_steal_reply(pending);
+    }
+    else
+    {
+        dbus_pending_call_cancel(pending);
+        dbus_set_error_const(&error, DBUS_ERROR_DISCONNECTED,
+                             "Connection was closed while waiting for the reply");
+    }
+    dbus_pending_call_unref(pending);
+
+    if (reply != 0 && dbus_set_error_from_message(&error, reply))
+    {
+        dbus_message_unref(reply);
+        reply = 0;
+    }
+
+    return reply;
+}
+
 bool TQT_DBusConnectionPrivate::handleUnreadMessages()
 {
   bool res = true;
@@ -362,11 +650,6 @@ bool TQT_DBusConnectionPrivate::handleUnreadMessages()
   return res;
 }
 
-void TQT_DBusConnectionPrivate::emitPendingCallReply(const TQT_DBusMessage& message)
-{
-    emit dbusPendingCallReply(message);
-}
-
 void TQT_DBusConnectionPrivate::bindToApplication()
 {
     // Yay, now that we have an application we are in business
@@ -427,21 +710,36 @@ void TQT_DBusConnectionPrivate::socketWrite(int fd)
 void TQT_DBusConnectionPrivate::objectDestroyed(TQObject* object)
 {
     //tqDebug("Object destroyed");
-    for (PendingCallMap::iterator it = pendingCalls.begin(); it != pendingCalls.end();)
+    ReceiverMap::iterator receiverIt = trackedReceivers.find(object);
+    if (receiverIt == trackedReceivers.end())
+        return;
+
+    TQT_DBusPendingCall* call = receiverIt.data().firstPendingCall;
+    while (call != 0)
     {
-        TQObject* receiver = (TQObject*) it.data()->receiver;
-        if (receiver == object || receiver == 0)
-        {
-            PendingCallMap::iterator copyIt = it;
-            ++it;
+        TQT_DBusPendingCall* next = call->next;
 
-            dbus_pending_call_cancel(copyIt.key());
-            dbus_pending_call_unref(copyIt.key());
-            delete copyIt.data();
-            pendingCalls.erase(copyIt);
-        }
-        else
-            ++it;
+        dbus_pending_call_cancel(call->pending);
+        dbus_pending_call_unref(call->pending);
+        pendingCalls.remove(call->pending);
+        delete call;
+
+        call = next;
+    }
+
+    // TQt has already removed the signal/slot connections
+    SignalConnectionList connections = receiverIt.data().signalConnections;
+    trackedReceivers.remove(receiverIt);
+
+    SignalConnectionList::const_iterator it    = connections.begin();
+    SignalConnectionList::const_iterator endIt = connections.end();
+    for (; it != endIt; ++it)
+    {
+        if ((*it).batch)
+            releaseBatchHook((*it).hook);
+        else if (!(*it).hook.isEmpty())
+            releaseSignalHook((*it).hook);
+        removeMatchRule((*it).rule);
     }
 }
 
@@ -511,29 +809,269 @@ void TQT_DBusConnectionPrivate::dispatch()
 
 void TQT_DBusConnectionPrivate::transmitMessageEmissionQueue()
 {
-    TQT_DBusConnectionPrivate::PendingMessagesForEmit::iterator pmfe;
-    pmfe = pendingMessages.begin();
-    while (pmfe != pendingMessages.end()) {
-        TQT_DBusMessage msg = *pmfe;
-        pmfe = pendingMessages.remove(pmfe);
-        dbusSignal(msg);
+    if (coalescePropertiesChanged)
+        coalescePendingMessages();
+
+    // signals received while emitting will be handled by the next run
+    PendingMessagesForEmit batch = pendingMessages;
+    pendingMessages.clear();
+
+    PendingMessagesForEmit::const_iterator it    = batch.begin();
+    PendingMessagesForEmit::const_iterator endIt = batch.end();
+    for (; it != endIt; ++it) {
+        // receivers may use the message as a plain TQValueList, so only the
+        // ones nobody receives stay lazy
+        if ((*it).isLazy() && receivers(TQ_SIGNAL(dbusSignal(const TQT_DBusMessage&))) != 0)
+            (*it).demarshallArguments();
+
+        dbusSignal(*it);
+        routeSignal(*it);
+    }
+
+    if (batch.isEmpty() || batchHooks.isEmpty())
+        return;
+
+    // receivers might disconnect while the batches are emitted, released
+    // hooks are only deleted later
+    TQPtrList<TQT_DBusSignalBatchHook> hooks;
+    TQDictIterator<TQT_DBusSignalBatchHook> hookIt(batchHooks);
+    for (; hookIt.current() != 0; ++hookIt)
+        hooks.append(hookIt.current());
+
+    TQPtrListIterator<TQT_DBusSignalBatchHook> listIt(hooks);
+    for (; listIt.current() != 0; ++listIt)
+    {
+        TQT_DBusSignalBatchHook* hook = listIt.current();
+        if (hook->isCatchAll())
+        {
+            for (it = batch.begin(); it != endIt; ++it)
+            {
+                if ((*it).isLazy()) (*it).demarshallArguments();
+            }
+
+            hook->emitSignalBatch(batch);
+            continue;
+        }
+
+        // copying de-marshalls lazy messages
+        PendingMessagesForEmit matching;
+        for (it = batch.begin(); it != endIt; ++it)
+        {
+            if (hook->matches(*it))
+                matching.append(*it);
+        }
+
+        if (!matching.isEmpty())
+            hook->emitSignalBatch(matching);
+    }
+}
+
+static bool qIsPropertiesChanged(const TQT_DBusMessage& message)
+{
+    return message.member() == "PropertiesChanged" &&
+           message.interface() == "org.freedesktop.DBus.Properties";
+}
+
+// merges the changes of a later PropertiesChanged signal into an earlier one
+static void qMergePropertiesChanged(TQT_DBusMessage& target, const TQT_DBusMessage& later)
+{
+    TQMap<TQString, TQT_DBusData> changed = target[1].toStringKeyMap().toTQMap();
+    TQStringList invalidated = target[2].toList().toTQStringList();
+
+    TQT_DBusDataMap<TQString> laterChanged = later[1].toStringKeyMap();
+    TQStringList laterInvalidated = later[2].toList().toTQStringList();
+
+    TQT_DBusDataMap<TQString>::const_iterator it    = laterChanged.begin();
+    TQT_DBusDataMap<TQString>::const_iterator endIt = laterChanged.end();
+    for (; it != endIt; ++it)
+    {
+        changed[it.key()] = it.data();
+        invalidated.remove(it.key());
+    }
+
+    TQStringList::const_iterator nameIt    = laterInvalidated.begin();
+    TQStringList::const_iterator nameEndIt = laterInvalidated.end();
+    for (; nameIt != nameEndIt; ++nameIt)
+    {
+        changed.remove(*nameIt);
+        if (!invalidated.contains(*nameIt))
+            invalidated << *nameIt;
+    }
+
+    TQT_DBusDataMap<TQString> merged(TQT_DBusData::Variant);
+    TQMap<TQString, TQT_DBusData>::const_iterator mapIt    = changed.begin();
+    TQMap<TQString, TQT_DBusData>::const_iterator mapEndIt = changed.end();
+    for (; mapIt != mapEndIt; ++mapIt)
+    {
+        merged.insert(mapIt.key(), mapIt.data());
+    }
+
+    target[1] = TQT_DBusData::fromStringKeyMap(merged);
+    target[2] = TQT_DBusData::fromList(TQT_DBusDataList(invalidated));
+}
+
+void TQT_DBusConnectionPrivate::coalescePendingMessages()
+{
+    // the merged signal takes the place of the last one it replaces, so it
+    // is not delivered ahead of signals the sender emitted in between
+    TQMap<TQString, PendingMessagesForEmit::iterator> lastOccurrence;
+
+    PendingMessagesForEmit::iterator it = pendingMessages.begin();
+    while (it != pendingMessages.end())
+    {
+        // checked on the raw message, so signals which are not merged stay lazy
+        DBusMessage* raw = (*it).d->msg;
+        if (!qIsPropertiesChanged(*it) || raw == 0 ||
+            !dbus_message_has_signature(raw, "sa{sv}as"))
+        {
+            ++it;
+            continue;
+        }
+
+        // the first argument is the name of the interface the properties belong to
+        DBusMessageIter args;
+        const char* interface = 0;
+        dbus_message_iter_init(raw, &args);
+        dbus_message_iter_get_basic(&args, &interface);
+
+        TQString key = hookKey((*it).sender(), (*it).path(), TQString::fromUtf8(interface),
+                               TQString::null);
+
+        TQMap<TQString, PendingMessagesForEmit::iterator>::iterator found =
+            lastOccurrence.find(key);
+        if (found == lastOccurrence.end())
+        {
+            lastOccurrence.insert(key, it);
+            ++it;
+            continue;
+        }
+
+        TQT_DBusMessage merged = *found.data();
+        qMergePropertiesChanged(merged, *it);
+        *it = merged;
+
+        pendingMessages.remove(found.data());
+        found.data() = it;
+        ++it;
+    }
+}
+
+bool TQT_DBusConnectionPrivate::connectSignalBatch(TQObject* receiver, const char* slot,
+                                                  const TQString& sender, const TQString& path,
+                                                  const TQString& interface, const TQString& member)
+{
+    // as for connectSignal(), only unique names can be matched locally
+    TQString hookSender = sender.startsWith(":") ? sender : TQString::null;
+
+    TQString key = hookKey(hookSender, path, interface, member);
+
+    TQT_DBusSignalBatchHook* hook = batchHooks.find(key);
+    if (hook == 0)
+    {
+        hook = new TQT_DBusSignalBatchHook(hookSender, path, interface, member);
+
+        if (batchHooks.count() >= batchHooks.size())
+            batchHooks.resize(batchHooks.size() * 2 + 1);
+        batchHooks.insert(key, hook);
+    }
+
+    if (!receiver->connect(hook, TQ_SIGNAL(dbusSignalBatch(const TQValueList<TQT_DBusMessage>&)),
+                           slot))
+    {
+        if (hook->users == 0)
+            batchHooks.remove(key);
+        return false;
+    }
+
+    ++hook->users;
+
+    TQString rule = matchRule(sender, path, interface, member);
+    addMatchRule(rule);
+    trackSignalReceiver(receiver, slot, key, rule, true);
+
+    return true;
+}
+
+bool TQT_DBusConnectionPrivate::disconnectSignalBatch(TQObject* receiver, const char* slot,
+                                                     const TQString& sender, const TQString& path,
+                                                     const TQString& interface, const TQString& member)
+{
+    TQString hookSender = sender.startsWith(":") ? sender : TQString::null;
+    TQString key = hookKey(hookSender, path, interface, member);
+
+    TQT_DBusSignalBatchHook* hook = batchHooks.find(key);
+    if (hook == 0 ||
+        !hook->disconnect(TQ_SIGNAL(dbusSignalBatch(const TQValueList<TQT_DBusMessage>&)),
+                          receiver, slot))
+        return false;
+
+    // TQt removed all equal connections, which each hold a reference
+    TQString rule = matchRule(sender, path, interface, member);
+    for (uint count = untrackSignalReceiver(receiver, slot, key, rule, true); count > 0; --count)
+    {
+        releaseBatchHook(key);
+        removeMatchRule(rule);
     }
+
+    return true;
 }
 
 bool TQT_DBusConnectionPrivate::handleObjectCall(DBusMessage *message)
 {
-    TQT_DBusMessage msg = TQT_DBusMessage::fromDBusMessage(message);
+    // look up the object first, calls to unknown paths are not de-marshalled
+    TQT_DBusObjectBase* object = findObject(headerStrings.string(dbus_message_get_path(message)));
+    if (object == 0)
+        return false;
 
-    ObjectMap::iterator it = registeredObjects.find(msg.path());
-    if (it == registeredObjects.end())
+    // the worker pool de-marshalls the call on the thread running it
+    if (workerPool != 0 && workerPool->enqueue(object, message))
+        return true;
+
+    TQT_DBusMessage msg = TQT_DBusMessage::fromDBusMessage(message, false, &headerStrings);
+
+    return object->handleMethodCall(msg);
+}
+
+bool TQT_DBusConnectionPrivate::registerObject(ObjectMap& map, const TQString& path,
+                                              TQT_DBusObjectBase* object)
+{
+    if (map.find(path) != 0)
         return false;
 
-    return it.data()->handleMethodCall(msg);
+    // keep the dictionary sparse enough for constant time lookups
+    if (map.count() >= map.size())
+        map.resize(map.size() * 2 + 1);
+
+    map.insert(path, object);
+
+    return true;
+}
+
+TQT_DBusObjectBase* TQT_DBusConnectionPrivate::findObject(const TQString& path) const
+{
+    TQT_DBusObjectBase* object = registeredObjects.find(path);
+    if (object != 0 || registeredTrees.isEmpty() || !path.startsWith("/"))
+        return object;
+
+    // walk up the path until a subtree handler is found
+    TQString prefix = path;
+    while (true)
+    {
+        object = registeredTrees.find(prefix);
+        if (object != 0 || prefix.length() == 1)
+            return object;
+
+        int slash = prefix.findRev('/');
+        prefix.truncate(slash > 0 ? slash : 1);
+    }
 }
 
 bool TQT_DBusConnectionPrivate::handleSignal(DBusMessage *message)
 {
-    TQT_DBusMessage msg = TQT_DBusMessage::fromDBusMessage(message);
+    // arguments are only de-marshalled when the signal is delivered to a
+    // receiver. Filled in place, copying would de-marshall it right away
+    PendingMessagesForEmit::iterator msgIt = pendingMessages.append(TQT_DBusMessage());
+    (*msgIt).initFromDBusMessage(message, true, &headerStrings);
 
     // yes, it is a single "|" below...
     // FIXME-QT4
@@ -542,12 +1080,316 @@ bool TQT_DBusConnectionPrivate::handleSignal(DBusMessage *message)
     // If dbusSignal(msg) were called here, it could easily cause a lockup as it would enter the TQt3 event loop,
     // which could result in arbitrary methods being called while still inside dbus_connection_dispatch.
     // Instead, I enqueue the messages here for TQt3 event loop transmission after dbus_connection_dispatch is finished.
-    pendingMessages.append(msg);
     if (!m_messageEmissionQueueTimer->isActive()) m_messageEmissionQueueTimer->start(0, TRUE);
 
     return true;
 }
 
+TQString TQT_DBusConnectionPrivate::catchAllMatchRule()
+{
+    return TQString::fromLatin1("type='signal'");
+}
+
+TQString TQT_DBusConnectionPrivate::matchRule(const TQString& sender, const TQString& path,
+                                             const TQString& interface, const TQString& member)
+{
+    TQString rule = catchAllMatchRule();
+
+    if (!sender.isEmpty())
+        rule += TQString::fromLatin1(",sender='%1'").arg(sender);
+    if (!path.isEmpty())
+        rule += TQString::fromLatin1(",path='%1'").arg(path);
+    if (!interface.isEmpty())
+        rule += TQString::fromLatin1(",interface='%1'").arg(interface);
+    if (!member.isEmpty())
+        rule += TQString::fromLatin1(",member='%1'").arg(member);
+
+    return rule;
+}
+
+void TQT_DBusConnectionPrivate::addMatchRule(const TQString& rule)
+{
+    MatchRuleMap::iterator it = matchRules.find(rule);
+    if (it != matchRules.end()) {
+        ++it.data();
+        return;
+    }
+
+    matchRules.insert(rule, 1);
+
+    // passing no error makes the call asynchronous, i.e. we do not block on
+    // the bus daemon's reply
+    if (connection && mode == ClientMode)
+        dbus_bus_add_match(connection, rule.utf8().data(), 0);
+}
+
+void TQT_DBusConnectionPrivate::removeMatchRule(const TQString& rule)
+{
+    MatchRuleMap::iterator it = matchRules.find(rule);
+    if (it == matchRules.end())
+        return;
+
+    if (--it.data() > 0)
+        return;
+
+    matchRules.remove(it);
+
+    if (connection && mode == ClientMode)
+        dbus_bus_remove_match(connection, rule.utf8().data(), 0);
+}
+
+TQString TQT_DBusConnectionPrivate::hookKey(const TQString& sender, const TQString& path,
+                                           const TQString& interface, const TQString& member)
+{
+    // blanks are not valid in any of the fields so they can separate them
+    TQString key = sender;
+    key += ' ';
+    key += path;
+    key += ' ';
+    key += interface;
+    key += ' ';
+    key += member;
+
+    return key;
+}
+
+bool TQT_DBusConnectionPrivate::connectAllSignals(TQObject* receiver, const char* slot)
+{
+    if (!receiver->connect(this, TQ_SIGNAL(dbusSignal(const TQT_DBusMessage&)), slot))
+        return false;
+
+    TQString rule = catchAllMatchRule();
+    addMatchRule(rule);
+    trackSignalReceiver(receiver, slot, TQString::null, rule);
+
+    return true;
+}
+
+bool TQT_DBusConnectionPrivate::disconnectAllSignals(TQObject* receiver, const char* slot)
+{
+    if (!disconnect(receiver, slot))
+        return false;
+
+    TQString rule = catchAllMatchRule();
+    for (uint count = untrackSignalReceiver(receiver, slot, TQString::null, rule); count > 0; --count)
+        removeMatchRule(rule);
+
+    return true;
+}
+
+bool TQT_DBusConnectionPrivate::connectSignal(TQObject* receiver, const char* slot,
+                                             const TQString& sender, const TQString& path,
+                                             const TQString& interface, const TQString& member)
+{
+    // signals always carry the unique name of their sender, well-known names
+    // are only resolved by the bus when it evaluates the match rule
+    TQString hookSender = sender.startsWith(":") ? sender : TQString::null;
+
+    int pattern = 0;
+    if (!hookSender.isEmpty()) pattern |= HookSender;
+    if (!path.isEmpty())       pattern |= HookPath;
+    if (!interface.isEmpty())  pattern |= HookInterface;
+    if (!member.isEmpty())     pattern |= HookMember;
+
+    TQString key = hookKey(hookSender, path, interface, member);
+
+    TQT_DBusSignalHook* hook = signalHooks.find(key);
+    if (hook == 0)
+    {
+        hook = new TQT_DBusSignalHook(pattern);
+
+        if (signalHooks.count() >= signalHooks.size())
+            signalHooks.resize(signalHooks.size() * 2 + 1);
+        signalHooks.insert(key, hook);
+        ++hookPatterns[pattern];
+    }
+
+    if (!receiver->connect(hook, TQ_SIGNAL(dbusSignal(const TQT_DBusMessage&)), slot))
+    {
+        if (hook->users == 0)
+        {
+            --hookPatterns[pattern];
+            signalHooks.remove(key);
+        }
+        return false;
+    }
+
+    ++hook->users;
+
+    TQString rule = matchRule(sender, path, interface, member);
+    addMatchRule(rule);
+    trackSignalReceiver(receiver, slot, key, rule);
+
+    return true;
+}
+
+bool TQT_DBusConnectionPrivate::disconnectSignal(TQObject* receiver, const char* slot,
+                                                const TQString& sender, const TQString& path,
+                                                const TQString& interface, const TQString& member)
+{
+    TQString hookSender = sender.startsWith(":") ? sender : TQString::null;
+    TQString key = hookKey(hookSender, path, interface, member);
+
+    TQT_DBusSignalHook* hook = signalHooks.find(key);
+    if (hook == 0 || !hook->disconnect(receiver, slot))
+        return false;
+
+    // TQt removed all equal connections, which each hold a reference
+    TQString rule = matchRule(sender, path, interface, member);
+    for (uint count = untrackSignalReceiver(receiver, slot, key, rule); count > 0; --count)
+    {
+        releaseSignalHook(key);
+        removeMatchRule(rule);
+    }
+
+    return true;
+}
+
+void TQT_DBusConnectionPrivate::routeSignal(const TQT_DBusMessage& message)
+{
+    if (signalHooks.isEmpty()) return;
+
+    const TQString sender    = message.sender();
+    const TQString path      = message.path();
+    const TQString interface = message.interface();
+    const TQString member    = message.member();
+
+    for (int pattern = 0; pattern < 16; ++pattern)
+    {
+        if (hookPatterns[pattern] == 0) continue;
+
+        TQString key = hookKey((pattern & HookSender)    ? sender    : TQString::null,
+                              (pattern & HookPath)      ? path      : TQString::null,
+                              (pattern & HookInterface) ? interface : TQString::null,
+                              (pattern & HookMember)    ? member    : TQString::null);
+
+        TQT_DBusSignalHook* hook = signalHooks.find(key);
+        if (hook == 0) continue;
+
+        if (message.isLazy()) message.demarshallArguments();
+        hook->emitSignal(message);
+    }
+}
+
+TQT_DBusConnectionPrivate::ReceiverMap::iterator
+TQT_DBusConnectionPrivate::trackReceiver(TQObject* receiver)
+{
+    ReceiverMap::iterator it = trackedReceivers.find(receiver);
+    if (it == trackedReceivers.end())
+    {
+        // entries are only removed when the receiver is destroyed, so this
+        // connection is made only once per receiver
+        TQObject::connect(receiver, TQ_SIGNAL(destroyed(TQObject*)),
+                          this, TQ_SLOT(objectDestroyed(TQObject*)));
+        it = trackedReceivers.insert(receiver, TrackedReceiver());
+    }
+
+    return it;
+}
+
+void TQT_DBusConnectionPrivate::trackSignalReceiver(TQObject* receiver, const char* slot,
+                                                   const TQString& hook, const TQString& rule,
+                                                   bool batch)
+{
+    ReceiverMap::iterator it = trackReceiver(receiver);
+
+    SignalConnection connection;
+    connection.hook  = hook;
+    connection.rule  = rule;
+    connection.slot  = TQObject::normalizeSignalSlot(slot);
+    connection.batch = batch;
+    it.data().signalConnections.append(connection);
+}
+
+uint TQT_DBusConnectionPrivate::untrackSignalReceiver(TQObject* receiver, const char* slot,
+                                                     const TQString& hook, const TQString& rule,
+                                                     bool batch)
+{
+    ReceiverMap::iterator it = trackedReceivers.find(receiver);
+    if (it == trackedReceivers.end())
+        return 0;
+
+    // disconnecting without slot removes the connections to all slots
+    TQCString normalizedSlot;
+    if (slot != 0) normalizedSlot = TQObject::normalizeSignalSlot(slot);
+
+    SignalConnectionList& connections = it.data().signalConnections;
+
+    uint count = 0;
+
+    SignalConnectionList::iterator connIt = connections.begin();
+    while (connIt != connections.end())
+    {
+        if ((*connIt).batch == batch && (*connIt).hook == hook && (*connIt).rule == rule &&
+            (slot == 0 || (*connIt).slot == normalizedSlot))
+        {
+            connIt = connections.remove(connIt);
+            ++count;
+        }
+        else
+            ++connIt;
+    }
+
+    return count;
+}
+
+void TQT_DBusConnectionPrivate::linkPendingCall(TQT_DBusPendingCall* call)
+{
+    ReceiverMap::iterator it = trackReceiver(call->receiver);
+
+    call->prev = 0;
+    call->next = it.data().firstPendingCall;
+    if (call->next != 0)
+        call->next->prev = call;
+
+    it.data().firstPendingCall = call;
+}
+
+void TQT_DBusConnectionPrivate::unlinkPendingCall(TQT_DBusPendingCall* call)
+{
+    if (call->next != 0)
+        call->next->prev = call->prev;
+
+    if (call->prev != 0)
+    {
+        call->prev->next = call->next;
+    }
+    else
+    {
+        ReceiverMap::iterator it = trackedReceivers.find(call->receiver);
+        if (it != trackedReceivers.end())
+            it.data().firstPendingCall = call->next;
+    }
+
+    call->prev = 0;
+    call->next = 0;
+}
+
+void TQT_DBusConnectionPrivate::releaseSignalHook(const TQString& key)
+{
+    TQT_DBusSignalHook* hook = signalHooks.find(key);
+    if (hook == 0 || --hook->users > 0)
+        return;
+
+    --hookPatterns[hook->pattern];
+    signalHooks.take(key);
+
+    // we might be called from within the hook's signal emission
+    hook->deleteLater();
+}
+
+void TQT_DBusConnectionPrivate::releaseBatchHook(const TQString& key)
+{
+    TQT_DBusSignalBatchHook* hook = batchHooks.find(key);
+    if (hook == 0 || --hook->users > 0)
+        return;
+
+    batchHooks.take(key);
+
+    // we might be called from within the hook's signal emission
+    hook->deleteLater();
+}
+
 static dbus_int32_t server_slot = -1;
 
 void TQT_DBusConnectionPrivate::setServer(DBusServer *s)
@@ -589,12 +1431,6 @@ void TQT_DBusConnectionPrivate::setConnection(DBusConnection *dbc)
     dbus_connection_set_timeout_functions(connection, qDBusAddTimeout, qDBusRemoveTimeout,
                                           qDBusToggleTimeout, this, 0);
 
-    dbus_bus_add_match(connection, "type='signal'", &error);
-    if (handleError()) {
-        closeConnection();
-        return;
-    }
-
     const char *service = dbus_bus_get_unique_name(connection);
     if (service) {
         TQCString filter;
@@ -630,20 +1466,24 @@ static void qDBusResultReceived(DBusPendingCall *pending, void *user_data)
     if (it != d->pendingCalls.end())
     {
         TQT_DBusMessage reply = TQT_DBusMessage::fromDBusMessage(dbusReply);
+        if (reply.type() == TQT_DBusMessage::ErrorMessage)
+            d->checkTimedOut(reply.error());
 
         TQT_DBusResultInfo dbusResult;
         dbusResult.message = reply;
         dbusResult.receiver = it.data()->receiver;
-        dbusResult.method = it.data()->method.data();
+        dbusResult.memberIndex = it.data()->memberIndex;
+        dbusResult.memberIsSignal = it.data()->memberIsSignal;
         d->m_resultEmissionQueue.append(dbusResult);
         d->newMethodInResultEmissionQueue();
+
+        d->unlinkPendingCall(it.data());
+        delete it.data();
+        d->pendingCalls.erase(it);
     }
 
     dbus_message_unref(dbusReply);
     dbus_pending_call_unref(pending);
-    delete it.data();
-
-    d->pendingCalls.erase(it);
 }
 
 int TQT_DBusConnectionPrivate::sendWithReplyAsync(const TQT_DBusMessage &message, TQObject *receiver,
@@ -652,9 +1492,32 @@ int TQT_DBusConnectionPrivate::sendWithReplyAsync(const TQT_DBusMessage &message
     if (!receiver || !method)
         return 0;
 
-    if (!TQObject::connect(receiver, TQ_SIGNAL(destroyed(TQObject*)),
-                          this, TQ_SLOT(objectDestroyed(TQObject*))))
-        return false;
+    // resolve the receiving member once instead of connecting to it for
+    // the reply. TQ_SLOT() and TQ_SIGNAL() prefix the signature with a code
+    const bool isSignal = method[0] == '2';
+    if (!isSignal && method[0] != '1') {
+        tqWarning("TQT_DBusConnection: use TQ_SLOT or TQ_SIGNAL for the reply receiver: %s",
+                  method);
+        return 0;
+    }
+
+    const TQCString member = normalizeSignalSlot(method + 1);
+    const int memberIndex = isSignal ? receiver->metaObject()->findSignal(member, TRUE)
+                                     : receiver->metaObject()->findSlot(member, TRUE);
+    if (memberIndex < 0) {
+        tqWarning("TQT_DBusConnection: no such %s %s::%s",
+                  isSignal ? "signal" : "slot", receiver->className(), member.data());
+        return 0;
+    }
+
+    // the member is invoked with the reply message as its argument, so it
+    // has to accept it like a connection to such a signal would
+    if (!checkConnectArgs("dbusPendingCallReply(const TQT_DBusMessage&)", receiver, member)) {
+        tqWarning("TQT_DBusConnection: incompatible %s %s::%s, expected an argument "
+                  "of type const TQT_DBusMessage& or none",
+                  isSignal ? "signal" : "slot", receiver->className(), member.data());
+        return 0;
+    }
 
     DBusMessage *msg = message.toDBusMessage();
     if (!msg)
@@ -662,12 +1525,14 @@ int TQT_DBusConnectionPrivate::sendWithReplyAsync(const TQT_DBusMessage &message
 
     int msg_serial = 0;
     DBusPendingCall *pending = 0;
-    if (dbus_connection_send_with_reply(connection, msg, &pending, message.timeout())) {
+    if (dbus_connection_send_with_reply(connection, msg, &pending, callTimeout(message))) {
         TQT_DBusPendingCall *pcall = new TQT_DBusPendingCall;
         pcall->receiver = receiver;
-        pcall->method = method;
+        pcall->memberIndex = memberIndex;
+        pcall->memberIsSignal = isSignal;
         pcall->pending = pending;
         pendingCalls.insert(pcall->pending, pcall);
+        linkPendingCall(pcall);
 
         dbus_pending_call_set_notify(pending, qDBusResultReceived, this, 0);
 
@@ -682,6 +1547,7 @@ void TQT_DBusConnectionPrivate::flush()
 {
     if (!connection) return;
 
+    TQT_DBusBlockingCall blocking(ioThread);
     dbus_connection_flush(connection);
 }
 
@@ -692,18 +1558,21 @@ void TQT_DBusConnectionPrivate::newMethodInResultEmissionQueue()
 
 void TQT_DBusConnectionPrivate::transmitResultEmissionQueue()
 {
-    if (!m_resultEmissionQueue.isEmpty()) {
-        TQT_DBusResultInfoList::Iterator it;
-        it = m_resultEmissionQueue.begin();
-        while (it != m_resultEmissionQueue.end()) {
-            TQT_DBusResultInfo dbusResult = (*it);
-            m_resultEmissionQueue.remove(it);
-            it = m_resultEmissionQueue.begin();
-
-            TQObject::connect(this, TQ_SIGNAL(dbusPendingCallReply(const TQT_DBusMessage&)), dbusResult.receiver, dbusResult.method.data());
-            emitPendingCallReply(dbusResult.message);
-            TQObject::disconnect(this, TQ_SIGNAL(dbusPendingCallReply(const TQT_DBusMessage&)), dbusResult.receiver, dbusResult.method.data());
-        }
+    while (!m_resultEmissionQueue.isEmpty()) {
+        TQT_DBusResultInfo dbusResult = m_resultEmissionQueue.first();
+        m_resultEmissionQueue.pop_front();
+
+        TQObject* receiver = dbusResult.receiver;
+        if (receiver == 0) continue;
+
+        // same as an emission through a connection would do
+        TQUObject o[2];
+        static_QUType_ptr.set(o + 1, &dbusResult.message);
+
+        if (dbusResult.memberIsSignal)
+            receiver->tqt_emit(dbusResult.memberIndex, o);
+        else
+            receiver->tqt_invoke(dbusResult.memberIndex, o);
     }
 }
 
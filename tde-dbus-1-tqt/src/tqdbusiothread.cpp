@@ -0,0 +1,189 @@
+/* tqdbusiothread.cpp background I/O for client connections
+ *
+ * Licensed under the Academic Free License version 2.1
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ *
+ */
+
+#include "tqdbusiothread_p.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <tqapplication.h>
+
+TQT_DBusIOThread::TQT_DBusIOThread(TQObject* receiver, DBusConnection* connection)
+    : m_receiver(receiver), m_connection(connection),
+      m_stopRequested(false), m_eventPosted(false), m_blockingCalls(0)
+{
+    dbus_connection_ref(m_connection);
+
+    if (::pipe(m_wakeupPipe) == 0)
+    {
+        ::fcntl(m_wakeupPipe[0], F_SETFL, O_NONBLOCK);
+        ::fcntl(m_wakeupPipe[1], F_SETFL, O_NONBLOCK);
+    }
+    else
+    {
+        tqWarning("TQT_DBusIOThread: unable to create wakeup pipe");
+        m_wakeupPipe[0] = -1;
+        m_wakeupPipe[1] = -1;
+    }
+}
+
+TQT_DBusIOThread::~TQT_DBusIOThread()
+{
+    stop();
+
+    if (m_wakeupPipe[0] != -1)
+    {
+        ::close(m_wakeupPipe[0]);
+        ::close(m_wakeupPipe[1]);
+    }
+
+    dbus_connection_unref(m_connection);
+}
+
+bool TQT_DBusIOThread::isValid() const
+{
+    return m_wakeupPipe[0] != -1;
+}
+
+void TQT_DBusIOThread::wakeUp()
+{
+    if (m_wakeupPipe[1] == -1) return;
+
+    // a full pipe already wakes the thread up, so errors can be ignored
+    char c = 0;
+    ssize_t res = ::write(m_wakeupPipe[1], &c, 1);
+    Q_UNUSED(res);
+}
+
+void TQT_DBusIOThread::stop()
+{
+    m_mutex.lock();
+    m_stopRequested = true;
+    m_blockingFinished.wakeAll();
+    m_mutex.unlock();
+
+    wakeUp();
+    wait();
+}
+
+void TQT_DBusIOThread::dispatched()
+{
+    m_mutex.lock();
+    m_eventPosted = false;
+    m_mutex.unlock();
+}
+
+void TQT_DBusIOThread::beginBlockingCall()
+{
+    m_mutex.lock();
+    ++m_blockingCalls;
+    m_mutex.unlock();
+}
+
+void TQT_DBusIOThread::endBlockingCall()
+{
+    m_mutex.lock();
+    if (--m_blockingCalls == 0)
+        m_blockingFinished.wakeAll();
+    m_mutex.unlock();
+}
+
+void TQT_DBusIOThread::postDispatch()
+{
+    m_mutex.lock();
+    bool post = !m_eventPosted;
+    m_eventPosted = true;
+    m_mutex.unlock();
+
+    if (post)
+        TQApplication::postEvent(m_receiver, new TQCustomEvent(DispatchEvent));
+}
+
+void TQT_DBusIOThread::run()
+{
+    int fd = -1;
+    if (!isValid() || !dbus_connection_get_unix_fd(m_connection, &fd))
+        return;
+
+    for (;;)
+    {
+        // leave the socket to blocking calls of other threads
+        m_mutex.lock();
+        bool waited = false;
+        while (m_blockingCalls > 0 && !m_stopRequested)
+        {
+            m_blockingFinished.wait(&m_mutex);
+            waited = true;
+        }
+        bool stopRequested = m_stopRequested;
+        m_mutex.unlock();
+        if (stopRequested) break;
+
+        // the blocking call may have queued messages besides its reply
+        if (waited &&
+            dbus_connection_get_dispatch_status(m_connection) == DBUS_DISPATCH_DATA_REMAINS)
+            postDispatch();
+
+        struct pollfd fds[2];
+        fds[0].fd      = m_wakeupPipe[0];
+        fds[0].events  = POLLIN;
+        fds[0].revents = 0;
+        fds[1].fd      = fd;
+        fds[1].events  = POLLIN;
+        fds[1].revents = 0;
+
+        if (dbus_connection_has_messages_to_send(m_connection))
+            fds[1].events |= POLLOUT;
+
+        if (::poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR) continue;
+
+            tqWarning("TQT_DBusIOThread: poll failed: %d", errno);
+            break;
+        }
+
+        if (fds[0].revents & POLLIN)
+        {
+            char buffer[64];
+            while (::read(m_wakeupPipe[0], buffer, sizeof(buffer)) > 0);
+        }
+
+        m_mutex.lock();
+        stopRequested = m_stopRequested;
+        m_mutex.unlock();
+        if (stopRequested) break;
+
+        if (fds[1].revents == 0) continue;
+
+        // does not block. Fails to make progress if a blocking call started
+        // since the check above, the next iteration then waits for it
+        bool connected = dbus_connection_read_write(m_connection, 0);
+
+        if (dbus_connection_get_dispatch_status(m_connection) == DBUS_DISPATCH_DATA_REMAINS)
+            postDispatch();
+
+        // dispatching the disconnect message is handled like any other
+        if (!connected) break;
+    }
+}
@@ -0,0 +1,127 @@
+/* tqdbusiothread_p.h background I/O for client connections
+ *
+ * Licensed under the Academic Free License version 2.1
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ *
+ */
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the public API.  This header file may
+// change from version to version without notice, or even be
+// removed.
+//
+// We mean it.
+//
+//
+
+#ifndef TQDBUSIOTHREAD_P_H
+#define TQDBUSIOTHREAD_P_H
+
+#include <tqevent.h>
+#include <tqmutex.h>
+#include <tqthread.h>
+#include <tqwaitcondition.h>
+
+#include <dbus/dbus.h>
+
+class TQObject;
+
+// Does the socket I/O of a client connection on a thread of its own.
+//
+// libdbus reads and parses inbound messages into the connection's queue and
+// writes the outbound ones. Whenever the queue has messages, a single
+// DispatchEvent is posted to the receiver, which dispatches them on the GUI
+// thread and calls dispatched() to allow the next event.
+//
+// Blocking libdbus calls made by other threads, e.g. sending with a reply or
+// flushing, do the socket I/O themselves. They are bracketed with
+// beginBlockingCall() and endBlockingCall() during which the thread does not
+// touch the socket but waits for the call to finish.
+class TQT_DBusIOThread : public TQThread
+{
+public:
+    enum { DispatchEvent = TQEvent::User + 0x4442 };
+
+    TQT_DBusIOThread(TQObject* receiver, DBusConnection* connection);
+    virtual ~TQT_DBusIOThread();
+
+    // false if the wakeup pipe could not be created
+    bool isValid() const;
+
+    // interrupts a wait for the socket, e.g. when messages are queued for
+    // sending
+    void wakeUp();
+
+    // makes the thread leave its loop and waits for it to finish
+    void stop();
+
+    void dispatched();
+
+    void beginBlockingCall();
+    void endBlockingCall();
+
+protected:
+    virtual void run();
+
+private:
+    void postDispatch();
+
+    // not copyable
+    TQT_DBusIOThread(const TQT_DBusIOThread&);
+    TQT_DBusIOThread& operator=(const TQT_DBusIOThread&);
+
+private:
+    TQObject* m_receiver;
+    DBusConnection* m_connection;
+
+    int m_wakeupPipe[2];
+
+    TQMutex m_mutex;
+    bool m_stopRequested;
+    bool m_eventPosted;
+
+    uint m_blockingCalls;
+    TQWaitCondition m_blockingFinished;
+};
+
+// brackets a blocking libdbus call with beginBlockingCall() and
+// endBlockingCall(), does nothing without I/O thread
+class TQT_DBusBlockingCall
+{
+public:
+    TQT_DBusBlockingCall(TQT_DBusIOThread* thread) : m_thread(thread)
+    {
+        if (m_thread != 0) m_thread->beginBlockingCall();
+    }
+
+    ~TQT_DBusBlockingCall()
+    {
+        if (m_thread != 0) m_thread->endBlockingCall();
+    }
+
+private:
+    TQT_DBusIOThread* m_thread;
+
+    // not copyable
+    TQT_DBusBlockingCall(const TQT_DBusBlockingCall&);
+    TQT_DBusBlockingCall& operator=(const TQT_DBusBlockingCall&);
+};
+
+#endif
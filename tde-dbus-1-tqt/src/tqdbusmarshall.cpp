@@ -22,6 +22,7 @@
  *
  */
 
+#include "tqdbusarena_p.h"
 #include "tqdbusmarshall.h"
 #include "tqdbusdata.h"
 #include "tqdbusdatalist.h"
@@ -30,6 +31,7 @@
 #include "tqdbusunixfd.h"
 #include "tqdbusvariant.h"
 
+#include <tqasciidict.h>
 #include <tqvariant.h>
 #include <tqvaluelist.h>
 #include <tqmap.h>
@@ -38,6 +40,8 @@
 
 #include <dbus/dbus.h>
 
+#include <string.h>
+
 template <typename T>
 inline T qIterGet(DBusMessageIter *it)
 {
@@ -72,361 +76,359 @@ static TQT_DBusData::Type qSingleTypeForDBusSignature(char signature)
     return TQT_DBusData::Invalid;
 }
 
-static TQValueList<TQT_DBusData> parseSignature(TQCString& signature)
+template <typename V>
+static TQT_DBusData qMapPrototype(TQT_DBusData::Type keyType, const V& valueType)
 {
-//    tqDebug("parseSignature(%s)", signature.data());
-    TQValueList<TQT_DBusData> result;
+    switch (keyType)
+    {
+        case TQT_DBusData::Byte:
+            return TQT_DBusData::fromByteKeyMap(TQT_DBusDataMap<TQ_UINT8>(valueType));
+        case TQT_DBusData::Int16:
+            return TQT_DBusData::fromInt16KeyMap(TQT_DBusDataMap<TQ_INT16>(valueType));
+        case TQT_DBusData::UInt16:
+            return TQT_DBusData::fromUInt16KeyMap(TQT_DBusDataMap<TQ_UINT16>(valueType));
+        case TQT_DBusData::Int32:
+            return TQT_DBusData::fromInt32KeyMap(TQT_DBusDataMap<TQ_INT32>(valueType));
+        case TQT_DBusData::UInt32:
+            return TQT_DBusData::fromUInt32KeyMap(TQT_DBusDataMap<TQ_UINT32>(valueType));
+        case TQT_DBusData::Int64:
+            return TQT_DBusData::fromInt64KeyMap(TQT_DBusDataMap<TQ_INT64>(valueType));
+        case TQT_DBusData::UInt64:
+            return TQT_DBusData::fromUInt64KeyMap(TQT_DBusDataMap<TQ_UINT64>(valueType));
+        case TQT_DBusData::String:
+            return TQT_DBusData::fromStringKeyMap(TQT_DBusDataMap<TQString>(valueType));
+        case TQT_DBusData::ObjectPath:
+            return TQT_DBusData::fromObjectPathKeyMap(
+                TQT_DBusDataMap<TQT_DBusObjectPath>(valueType));
+        case TQT_DBusData::UnixFd:
+            return TQT_DBusData::fromUnixFdKeyMap(TQT_DBusDataMap<TQT_DBusUnixFd>(valueType));
+        default:
+            tqWarning("TQT_DBusMarshall: unsupported map key type %s "
+                     "at de-marshalling",
+                     TQT_DBusData::typeName(keyType));
+            return TQT_DBusData();
+    }
+}
 
-    while (!signature.isEmpty())
+// parses the single complete type starting at signature[pos] into a
+// prototype value and advances pos behind it
+static TQT_DBusData parseSingleType(const char* signature, uint& pos)
+{
+//    tqDebug("parseSingleType(%s)", signature + pos);
+    switch (signature[pos])
     {
-        switch (signature[0])
-        {
-            case '(': {
-                signature = signature.mid(1);
-                TQValueList<TQT_DBusData> memberList = parseSignature(signature);
-                result << TQT_DBusData::fromStruct(memberList);
-                Q_ASSERT(!signature.isEmpty() && signature[0] == ')');
-                signature = signature.mid(1);
-                break;
+        case '\0':
+            return TQT_DBusData();
+
+        case '(': {
+            ++pos;
+            TQValueList<TQT_DBusData> memberList;
+            while (signature[pos] != '\0' && signature[pos] != ')')
+            {
+                memberList << parseSingleType(signature, pos);
             }
-            case ')': return result;
-            case '{': {
-                TQT_DBusData::Type keyType =
-                    qSingleTypeForDBusSignature(signature[1]);
-                TQT_DBusData::Type valueType =
-                    qSingleTypeForDBusSignature(signature[2]);
-                if (valueType != TQT_DBusData::Invalid)
-                {
-                    switch (keyType)
-                    {
-                        case TQT_DBusData::Byte:
-                            result << TQT_DBusData::fromByteKeyMap(
-                                TQT_DBusDataMap<TQ_UINT8>(valueType));
-                            break;
-                        case TQT_DBusData::Int16:
-                            result << TQT_DBusData::fromInt16KeyMap(
-                                TQT_DBusDataMap<TQ_INT16>(valueType));
-                            break;
-                        case TQT_DBusData::UInt16:
-                            result << TQT_DBusData::fromUInt16KeyMap(
-                                TQT_DBusDataMap<TQ_UINT16>(valueType));
-                            break;
-                        case TQT_DBusData::Int32:
-                            result << TQT_DBusData::fromInt32KeyMap(
-                                TQT_DBusDataMap<TQ_INT32>(valueType));
-                            break;
-                        case TQT_DBusData::UInt32:
-                            result << TQT_DBusData::fromUInt32KeyMap(
-                                TQT_DBusDataMap<TQ_UINT32>(valueType));
-                            break;
-                        case TQT_DBusData::Int64:
-                            result << TQT_DBusData::fromInt64KeyMap(
-                                TQT_DBusDataMap<TQ_INT64>(valueType));
-                            break;
-                        case TQT_DBusData::UInt64:
-                            result << TQT_DBusData::fromUInt64KeyMap(
-                                TQT_DBusDataMap<TQ_UINT64>(valueType));
-                            break;
-                        case TQT_DBusData::String:
-                            result << TQT_DBusData::fromStringKeyMap(
-                                TQT_DBusDataMap<TQString>(valueType));
-                            break;
-                        case TQT_DBusData::ObjectPath:
-                            result << TQT_DBusData::fromObjectPathKeyMap(
-                                TQT_DBusDataMap<TQT_DBusObjectPath>(valueType));
-                            break;
-                        case TQT_DBusData::UnixFd:
-                            result << TQT_DBusData::fromUnixFdKeyMap(
-                                TQT_DBusDataMap<TQT_DBusUnixFd>(valueType));
-                            break;
-                        default:
-                            tqWarning("TQT_DBusMarshall: unsupported map key type %s "
-                                     "at de-marshalling",
-                                     TQT_DBusData::typeName(keyType));
-                            break;
-                    }
-                    signature = signature.mid(3);
-                }
-                else
-                {
-                    signature = signature.mid(2);
-                    TQValueList<TQT_DBusData> valueContainer =
-                        parseSignature(signature);
-                    Q_ASSERT(valueContainer.count() == 1);
-
-                    switch (keyType)
-                    {
-                        case TQT_DBusData::Byte:
-                            result << TQT_DBusData::fromByteKeyMap(
-                                TQT_DBusDataMap<TQ_UINT8>(valueContainer[0]));
-                            break;
-                        case TQT_DBusData::Int16:
-                            result << TQT_DBusData::fromInt16KeyMap(
-                                TQT_DBusDataMap<TQ_INT16>(valueContainer[0]));
-                            break;
-                        case TQT_DBusData::UInt16:
-                            result << TQT_DBusData::fromUInt16KeyMap(
-                                TQT_DBusDataMap<TQ_UINT16>(valueContainer[0]));
-                            break;
-                        case TQT_DBusData::Int32:
-                            result << TQT_DBusData::fromInt32KeyMap(
-                                TQT_DBusDataMap<TQ_INT32>(valueContainer[0]));
-                            break;
-                        case TQT_DBusData::UInt32:
-                            result << TQT_DBusData::fromUInt32KeyMap(
-                                TQT_DBusDataMap<TQ_UINT32>(valueContainer[0]));
-                            break;
-                        case TQT_DBusData::Int64:
-                            result << TQT_DBusData::fromInt64KeyMap(
-                                TQT_DBusDataMap<TQ_INT64>(valueContainer[0]));
-                            break;
-                        case TQT_DBusData::UInt64:
-                            result << TQT_DBusData::fromUInt64KeyMap(
-                                TQT_DBusDataMap<TQ_UINT64>(valueContainer[0]));
-                            break;
-                        case TQT_DBusData::String:
-                            result << TQT_DBusData::fromStringKeyMap(
-                                TQT_DBusDataMap<TQString>(valueContainer[0]));
-                            break;
-                        case TQT_DBusData::ObjectPath:
-                            result << TQT_DBusData::fromObjectPathKeyMap(
-                                TQT_DBusDataMap<TQT_DBusObjectPath>(valueContainer[0]));
-                            break;
-                        case TQT_DBusData::UnixFd:
-                            result << TQT_DBusData::fromUnixFdKeyMap(
-                                TQT_DBusDataMap<TQT_DBusUnixFd>(valueContainer[0]));
-                            break;
-                        default:
-                            tqWarning("TQT_DBusMarshall: unsupported map key type %s "
-                                     "at de-marshalling",
-                                     TQT_DBusData::typeName(keyType));
-                            break;
-                    }
-                }
-                Q_ASSERT(!signature.isEmpty() && signature[0] == '}');
-                signature = signature.mid(1);
-                break;
+            Q_ASSERT(signature[pos] == ')');
+            if (signature[pos] == ')') ++pos;
+
+            return TQT_DBusData::fromStruct(memberList);
+        }
+
+        case '{': {
+            TQT_DBusData::Type keyType =
+                qSingleTypeForDBusSignature(signature[pos + 1]);
+            pos += 2;
+
+            TQT_DBusData map;
+
+            TQT_DBusData::Type valueType =
+                qSingleTypeForDBusSignature(signature[pos]);
+            if (valueType != TQT_DBusData::Invalid)
+            {
+                ++pos;
+                map = qMapPrototype(keyType, valueType);
             }
-            case '}': return result;
-            case 'a': {
-                TQT_DBusData::Type elementType =
-                    qSingleTypeForDBusSignature(signature[1]);
-                if (elementType != TQT_DBusData::Invalid)
-                {
-                    TQT_DBusDataList list(elementType);
-                    result << TQT_DBusData::fromList(list);
-                    signature = signature.mid(2);
-                }
-                else
-                {
-                    signature = signature.mid(1);
-                    bool array = signature[0] != '{';
-
-                    TQValueList<TQT_DBusData> elementContainer =
-                        parseSignature(signature);
-                    Q_ASSERT(elementContainer.count() == 1);
-
-                    if (array)
-                    {
-                        TQT_DBusDataList list(elementContainer[0]);
-                        result << TQT_DBusData::fromList(list);
-                    }
-                    else
-                        result << elementContainer[0];
-                }
-                break;
+            else
+                map = qMapPrototype(keyType, parseSingleType(signature, pos));
+
+            Q_ASSERT(signature[pos] == '}');
+            if (signature[pos] == '}') ++pos;
+
+            return map;
+        }
+
+        case 'a': {
+            ++pos;
+
+            TQT_DBusData::Type elementType =
+                qSingleTypeForDBusSignature(signature[pos]);
+            if (elementType != TQT_DBusData::Invalid)
+            {
+                ++pos;
+                return TQT_DBusData::fromList(TQT_DBusDataList(elementType));
             }
+
+            // dictionaries are represented by their map prototype
+            if (signature[pos] == '{')
+                return parseSingleType(signature, pos);
+
+            return TQT_DBusData::fromList(
+                TQT_DBusDataList(parseSingleType(signature, pos)));
+        }
+
+        default:
+            break;
+    }
+
+    TQT_DBusData::Type elementType = qSingleTypeForDBusSignature(signature[pos]);
+    ++pos;
+
+    switch (elementType)
+    {
+        case TQT_DBusData::Invalid:
+            return TQT_DBusData();
+        case TQT_DBusData::Bool:
+            return TQT_DBusData::fromBool(0);
+        case TQT_DBusData::Byte:
+            return TQT_DBusData::fromByte(0);
+        case TQT_DBusData::Int16:
+            return TQT_DBusData::fromInt16(0);
+        case TQT_DBusData::UInt16:
+            return TQT_DBusData::fromUInt16(0);
+        case TQT_DBusData::Int32:
+            return TQT_DBusData::fromInt32(0);
+        case TQT_DBusData::UInt32:
+            return TQT_DBusData::fromUInt32(0);
+        case TQT_DBusData::Int64:
+            return TQT_DBusData::fromInt64(0);
+        case TQT_DBusData::UInt64:
+            return TQT_DBusData::fromUInt64(0);
+        case TQT_DBusData::Double:
+            return TQT_DBusData::fromDouble(0.0);
+        case TQT_DBusData::String:
+            return TQT_DBusData::fromString(TQString());
+        case TQT_DBusData::ObjectPath:
+            return TQT_DBusData::fromObjectPath(TQT_DBusObjectPath());
+        case TQT_DBusData::Variant:
+            return TQT_DBusData::fromVariant(TQT_DBusVariant());
+        case TQT_DBusData::UnixFd:
+            return TQT_DBusData::fromUnixFd(TQT_DBusUnixFd());
+        default:
+            tqWarning("TQT_DBusMarshall: unsupported element type %s "
+                     "at de-marshalling",
+                     TQT_DBusData::typeName(elementType));
+            return TQT_DBusData();
+    }
+}
+
+// container prototypes are immutable and implicitly shared, so the ones
+// for signatures already seen are kept for reuse
+static const uint maxCachedSignatures = 256;
+
+// one cache per thread, since copies of the prototypes share TQt containers
+// whose reference counts are not thread-safe
+static __thread TQAsciiDict<TQT_DBusData>* prototypeCache = 0;
+
+static TQT_DBusData qPrototypeForSignature(const char* signature)
+{
+    if (prototypeCache == 0)
+    {
+        prototypeCache = new TQAsciiDict<TQT_DBusData>(101);
+        prototypeCache->setAutoDelete(true);
+    }
+
+    TQT_DBusData* cached = prototypeCache->find(signature);
+    if (cached != 0) return *cached;
+
+    // the cache outlives the message being de-marshalled, so its entries
+    // must not be allocated from the message's arena
+    TQT_DBusArena::Scope noArena(0);
+
+    uint pos = 0;
+    TQT_DBusData prototype = parseSingleType(signature, pos);
+
+    // unusual workloads might create lots of distinct signatures
+    if (prototypeCache->count() >= maxCachedSignatures)
+        prototypeCache->clear();
+
+    prototypeCache->insert(signature, new TQT_DBusData(prototype));
+
+    return prototype;
+}
+
+void TQT_DBusMarshall::releaseThreadCache()
+{
+    delete prototypeCache;
+    prototypeCache = 0;
+}
+
+// returns the position behind the single complete type starting at
+// signature
+static const char* qSkipSingleType(const char* signature)
+{
+    int depth = 0;
+    for (;;)
+    {
+        switch (*signature)
+        {
+            case '\0':
+                return signature;
+
+            case 'a': // the element type follows
+                ++signature;
+                continue;
+
+            case '(': // fall through
+            case '{':
+                ++depth;
+                break;
+
+            case ')': // fall through
+            case '}':
+                --depth;
+                break;
+
             default:
-                TQT_DBusData::Type elementType =
-                    qSingleTypeForDBusSignature(signature[0]);
-                if (elementType != TQT_DBusData::Invalid)
-                {
-                    switch (elementType)
-                    {
-                        case TQT_DBusData::Bool:
-                            result << TQT_DBusData::fromBool(
-                                (0));
-                            break;
-                        case TQT_DBusData::Byte:
-                            result << TQT_DBusData::fromByte(
-                                (0));
-                            break;
-                        case TQT_DBusData::Int16:
-                            result << TQT_DBusData::fromInt16(
-                                (0));
-                            break;
-                        case TQT_DBusData::UInt16:
-                            result << TQT_DBusData::fromUInt16(
-                                (0));
-                            break;
-                        case TQT_DBusData::Int32:
-                            result << TQT_DBusData::fromInt32(
-                                (0));
-                            break;
-                        case TQT_DBusData::UInt32:
-                            result << TQT_DBusData::fromUInt32(
-                                (0));
-                            break;
-                        case TQT_DBusData::Int64:
-                            result << TQT_DBusData::fromInt64(
-                                (0));
-                            break;
-                        case TQT_DBusData::UInt64:
-                            result << TQT_DBusData::fromUInt64(
-                                (0));
-                            break;
-                        case TQT_DBusData::String:
-                            result << TQT_DBusData::fromString(
-                                (TQString()));
-                            break;
-                        case TQT_DBusData::ObjectPath:
-                            result << TQT_DBusData::fromObjectPath(
-                                (TQT_DBusObjectPath()));
-                            break;
-                        case TQT_DBusData::UnixFd:
-                            result << TQT_DBusData::fromUnixFd(
-                                (TQT_DBusUnixFd()));
-                            break;
-                        default:
-                            result << TQT_DBusData();
-                            tqWarning("TQT_DBusMarshall: unsupported element type %s "
-                                     "at de-marshalling",
-                                     TQT_DBusData::typeName(elementType));
-                            break;
-                    }
-                    signature = signature.mid(1);
-                }
-                else {
-                    result << TQT_DBusData();
-                    signature = signature.mid(1);
-                }
                 break;
         }
-    }
 
-    return result;
+        ++signature;
+        if (depth == 0) return signature;
+    }
 }
 
-static TQT_DBusData qFetchParameter(DBusMessageIter *it);
+// signature is the one of the value at it, usually a part of the signature
+// of its message or container. Knowing it avoids asking libdbus for the
+// signature of every container
+static TQT_DBusData qFetchParameter(DBusMessageIter *it, const char* signature);
 
-void qFetchByteKeyMapEntry(TQT_DBusDataMap<TQ_UINT8>& map, DBusMessageIter* it)
+void qFetchByteKeyMapEntry(TQT_DBusDataMap<TQ_UINT8>& map, DBusMessageIter* it,
+                           const char* entrySignature)
 {
     DBusMessageIter itemIter;
     dbus_message_iter_recurse(it, &itemIter);
     Q_ASSERT(dbus_message_iter_has_next(&itemIter));
 
-    TQ_UINT8 key = qFetchParameter(&itemIter).toByte();
+    TQ_UINT8 key = qFetchParameter(&itemIter, entrySignature + 1).toByte();
 
     dbus_message_iter_next(&itemIter);
 
-    map.insert(key, qFetchParameter(&itemIter));
+    map.insert(key, qFetchParameter(&itemIter, entrySignature + 2));
 }
 
-void qFetchInt16KeyMapEntry(TQT_DBusDataMap<TQ_INT16>& map, DBusMessageIter* it)
+void qFetchInt16KeyMapEntry(TQT_DBusDataMap<TQ_INT16>& map, DBusMessageIter* it,
+                            const char* entrySignature)
 {
     DBusMessageIter itemIter;
     dbus_message_iter_recurse(it, &itemIter);
     Q_ASSERT(dbus_message_iter_has_next(&itemIter));
 
-    TQ_INT16 key = qFetchParameter(&itemIter).toInt16();
+    TQ_INT16 key = qFetchParameter(&itemIter, entrySignature + 1).toInt16();
 
     dbus_message_iter_next(&itemIter);
 
-    map.insert(key, qFetchParameter(&itemIter));
+    map.insert(key, qFetchParameter(&itemIter, entrySignature + 2));
 }
 
-void qFetchUInt16KeyMapEntry(TQT_DBusDataMap<TQ_UINT16>& map, DBusMessageIter* it)
+void qFetchUInt16KeyMapEntry(TQT_DBusDataMap<TQ_UINT16>& map, DBusMessageIter* it,
+                             const char* entrySignature)
 {
     DBusMessageIter itemIter;
     dbus_message_iter_recurse(it, &itemIter);
     Q_ASSERT(dbus_message_iter_has_next(&itemIter));
 
-    TQ_UINT16 key = qFetchParameter(&itemIter).toUInt16();
+    TQ_UINT16 key = qFetchParameter(&itemIter, entrySignature + 1).toUInt16();
 
     dbus_message_iter_next(&itemIter);
 
-    map.insert(key, qFetchParameter(&itemIter));
+    map.insert(key, qFetchParameter(&itemIter, entrySignature + 2));
 }
 
-void qFetchInt32KeyMapEntry(TQT_DBusDataMap<TQ_INT32>& map, DBusMessageIter* it)
+void qFetchInt32KeyMapEntry(TQT_DBusDataMap<TQ_INT32>& map, DBusMessageIter* it,
+                            const char* entrySignature)
 {
     DBusMessageIter itemIter;
     dbus_message_iter_recurse(it, &itemIter);
     Q_ASSERT(dbus_message_iter_has_next(&itemIter));
 
-    TQ_INT32 key = qFetchParameter(&itemIter).toInt32();
+    TQ_INT32 key = qFetchParameter(&itemIter, entrySignature + 1).toInt32();
 
     dbus_message_iter_next(&itemIter);
 
-    map.insert(key, qFetchParameter(&itemIter));
+    map.insert(key, qFetchParameter(&itemIter, entrySignature + 2));
 }
 
-void qFetchUInt32KeyMapEntry(TQT_DBusDataMap<TQ_UINT32>& map, DBusMessageIter* it)
+void qFetchUInt32KeyMapEntry(TQT_DBusDataMap<TQ_UINT32>& map, DBusMessageIter* it,
+                             const char* entrySignature)
 {
     DBusMessageIter itemIter;
     dbus_message_iter_recurse(it, &itemIter);
     Q_ASSERT(dbus_message_iter_has_next(&itemIter));
 
-    TQ_UINT32 key = qFetchParameter(&itemIter).toUInt32();
+    TQ_UINT32 key = qFetchParameter(&itemIter, entrySignature + 1).toUInt32();
 
     dbus_message_iter_next(&itemIter);
 
-    map.insert(key, qFetchParameter(&itemIter));
+    map.insert(key, qFetchParameter(&itemIter, entrySignature + 2));
 }
 
-void qFetchInt64KeyMapEntry(TQT_DBusDataMap<TQ_INT64>& map, DBusMessageIter* it)
+void qFetchInt64KeyMapEntry(TQT_DBusDataMap<TQ_INT64>& map, DBusMessageIter* it,
+                            const char* entrySignature)
 {
     DBusMessageIter itemIter;
     dbus_message_iter_recurse(it, &itemIter);
     Q_ASSERT(dbus_message_iter_has_next(&itemIter));
 
-    TQ_INT64 key = qFetchParameter(&itemIter).toInt64();
+    TQ_INT64 key = qFetchParameter(&itemIter, entrySignature + 1).toInt64();
 
     dbus_message_iter_next(&itemIter);
 
-    map.insert(key, qFetchParameter(&itemIter));
+    map.insert(key, qFetchParameter(&itemIter, entrySignature + 2));
 }
 
-void qFetchUInt64KeyMapEntry(TQT_DBusDataMap<TQ_UINT64>& map, DBusMessageIter* it)
+void qFetchUInt64KeyMapEntry(TQT_DBusDataMap<TQ_UINT64>& map, DBusMessageIter* it,
+                             const char* entrySignature)
 {
     DBusMessageIter itemIter;
     dbus_message_iter_recurse(it, &itemIter);
     Q_ASSERT(dbus_message_iter_has_next(&itemIter));
 
-    TQ_UINT64 key = qFetchParameter(&itemIter).toUInt64();
+    TQ_UINT64 key = qFetchParameter(&itemIter, entrySignature + 1).toUInt64();
 
     dbus_message_iter_next(&itemIter);
 
-    map.insert(key, qFetchParameter(&itemIter));
+    map.insert(key, qFetchParameter(&itemIter, entrySignature + 2));
 }
 
-void qFetchObjectPathKeyMapEntry(TQT_DBusDataMap<TQT_DBusObjectPath>& map, DBusMessageIter* it)
+void qFetchObjectPathKeyMapEntry(TQT_DBusDataMap<TQT_DBusObjectPath>& map, DBusMessageIter* it,
+                                 const char* entrySignature)
 {
     DBusMessageIter itemIter;
     dbus_message_iter_recurse(it, &itemIter);
     Q_ASSERT(dbus_message_iter_has_next(&itemIter));
 
-    TQT_DBusObjectPath key = qFetchParameter(&itemIter).toObjectPath();
+    TQT_DBusObjectPath key = qFetchParameter(&itemIter, entrySignature + 1).toObjectPath();
 
     dbus_message_iter_next(&itemIter);
 
-    map.insert(key, qFetchParameter(&itemIter));
+    map.insert(key, qFetchParameter(&itemIter, entrySignature + 2));
 }
 
-void qFetchStringKeyMapEntry(TQT_DBusDataMap<TQString>& map, DBusMessageIter* it)
+void qFetchStringKeyMapEntry(TQT_DBusDataMap<TQString>& map, DBusMessageIter* it,
+                             const char* entrySignature)
 {
     DBusMessageIter itemIter;
     dbus_message_iter_recurse(it, &itemIter);
     Q_ASSERT(dbus_message_iter_has_next(&itemIter));
 
-    TQString key = qFetchParameter(&itemIter).toString();
+    TQString key = qFetchParameter(&itemIter, entrySignature + 1).toString();
 
     dbus_message_iter_next(&itemIter);
 
-    map.insert(key, qFetchParameter(&itemIter));
+    map.insert(key, qFetchParameter(&itemIter, entrySignature + 2));
 }
 
-static TQT_DBusData qFetchMap(DBusMessageIter *it, const TQT_DBusData& prototype)
+static TQT_DBusData qFetchMap(DBusMessageIter *it, const TQT_DBusData& prototype,
+                              const char* entrySignature)
 {
     if (dbus_message_iter_get_arg_type(it) == DBUS_TYPE_INVALID)
         return prototype;
@@ -440,7 +442,7 @@ static TQT_DBusData qFetchMap(DBusMessageIter *it, const TQT_DBusData& prototype
         case DBUS_TYPE_BYTE: {
             TQT_DBusDataMap<TQ_UINT8> map = prototype.toByteKeyMap();
             do {
-                qFetchByteKeyMapEntry(map, it);
+                qFetchByteKeyMapEntry(map, it, entrySignature);
             } while (dbus_message_iter_next(it));
 
             return TQT_DBusData::fromByteKeyMap(map);
@@ -449,7 +451,7 @@ static TQT_DBusData qFetchMap(DBusMessageIter *it, const TQT_DBusData& prototype
         case DBUS_TYPE_INT16: {
             TQT_DBusDataMap<TQ_INT16> map = prototype.toInt16KeyMap();
             do {
-                qFetchInt16KeyMapEntry(map, it);
+                qFetchInt16KeyMapEntry(map, it, entrySignature);
             } while (dbus_message_iter_next(it));
 
             return TQT_DBusData::fromInt16KeyMap(map);
@@ -458,7 +460,7 @@ static TQT_DBusData qFetchMap(DBusMessageIter *it, const TQT_DBusData& prototype
         case DBUS_TYPE_UINT16: {
             TQT_DBusDataMap<TQ_UINT16> map = prototype.toUInt16KeyMap();
             do {
-                qFetchUInt16KeyMapEntry(map, it);
+                qFetchUInt16KeyMapEntry(map, it, entrySignature);
             } while (dbus_message_iter_next(it));
 
             return TQT_DBusData::fromUInt16KeyMap(map);
@@ -467,7 +469,7 @@ static TQT_DBusData qFetchMap(DBusMessageIter *it, const TQT_DBusData& prototype
         case DBUS_TYPE_INT32: {
             TQT_DBusDataMap<TQ_INT32> map = prototype.toInt32KeyMap();
             do {
-                qFetchInt32KeyMapEntry(map, it);
+                qFetchInt32KeyMapEntry(map, it, entrySignature);
             } while (dbus_message_iter_next(it));
 
             return TQT_DBusData::fromInt32KeyMap(map);
@@ -476,7 +478,7 @@ static TQT_DBusData qFetchMap(DBusMessageIter *it, const TQT_DBusData& prototype
         case DBUS_TYPE_UINT32: {
             TQT_DBusDataMap<TQ_UINT32> map = prototype.toUInt32KeyMap();
             do {
-                qFetchUInt32KeyMapEntry(map, it);
+                qFetchUInt32KeyMapEntry(map, it, entrySignature);
             } while (dbus_message_iter_next(it));
 
             return TQT_DBusData::fromUInt32KeyMap(map);
@@ -485,7 +487,7 @@ static TQT_DBusData qFetchMap(DBusMessageIter *it, const TQT_DBusData& prototype
         case DBUS_TYPE_INT64: {
             TQT_DBusDataMap<TQ_INT64> map = prototype.toInt64KeyMap();
             do {
-                qFetchInt64KeyMapEntry(map, it);
+                qFetchInt64KeyMapEntry(map, it, entrySignature);
             } while (dbus_message_iter_next(it));
 
             return TQT_DBusData::fromInt64KeyMap(map);
@@ -494,7 +496,7 @@ static TQT_DBusData qFetchMap(DBusMessageIter *it, const TQT_DBusData& prototype
         case DBUS_TYPE_UINT64: {
             TQT_DBusDataMap<TQ_UINT64> map = prototype.toUInt64KeyMap();
             do {
-                qFetchUInt64KeyMapEntry(map, it);
+                qFetchUInt64KeyMapEntry(map, it, entrySignature);
             } while (dbus_message_iter_next(it));
 
             return TQT_DBusData::fromUInt64KeyMap(map);
@@ -503,7 +505,7 @@ static TQT_DBusData qFetchMap(DBusMessageIter *it, const TQT_DBusData& prototype
         case DBUS_TYPE_OBJECT_PATH:  {
             TQT_DBusDataMap<TQT_DBusObjectPath> map = prototype.toObjectPathKeyMap();
             do {
-            	qFetchObjectPathKeyMapEntry(map, it);
+            	qFetchObjectPathKeyMapEntry(map, it, entrySignature);
             } while (dbus_message_iter_next(it));
 
             return TQT_DBusData::fromObjectPathKeyMap(map);
@@ -512,7 +514,7 @@ static TQT_DBusData qFetchMap(DBusMessageIter *it, const TQT_DBusData& prototype
         case DBUS_TYPE_SIGNATURE: {
             TQT_DBusDataMap<TQString> map = prototype.toStringKeyMap();
             do {
-                qFetchStringKeyMapEntry(map, it);
+                qFetchStringKeyMapEntry(map, it, entrySignature);
             } while (dbus_message_iter_next(it));
 
             return TQT_DBusData::fromStringKeyMap(map);
@@ -525,7 +527,33 @@ static TQT_DBusData qFetchMap(DBusMessageIter *it, const TQT_DBusData& prototype
     return prototype;
 }
 
-static TQT_DBusData qFetchParameter(DBusMessageIter *it)
+static TQT_DBusData::Type qFixedTypeForDBusType(int dbusType)
+{
+    switch (dbusType) {
+    case DBUS_TYPE_BOOLEAN:
+        return TQT_DBusData::Bool;
+    case DBUS_TYPE_BYTE:
+        return TQT_DBusData::Byte;
+    case DBUS_TYPE_INT16:
+        return TQT_DBusData::Int16;
+    case DBUS_TYPE_UINT16:
+        return TQT_DBusData::UInt16;
+    case DBUS_TYPE_INT32:
+        return TQT_DBusData::Int32;
+    case DBUS_TYPE_UINT32:
+        return TQT_DBusData::UInt32;
+    case DBUS_TYPE_INT64:
+        return TQT_DBusData::Int64;
+    case DBUS_TYPE_UINT64:
+        return TQT_DBusData::UInt64;
+    case DBUS_TYPE_DOUBLE:
+        return TQT_DBusData::Double;
+    default:
+        return TQT_DBusData::Invalid;
+    }
+}
+
+static TQT_DBusData qFetchParameter(DBusMessageIter *it, const char* signature)
 {
     switch (dbus_message_iter_get_arg_type(it)) {
     case DBUS_TYPE_BOOLEAN:
@@ -554,25 +582,42 @@ static TQT_DBusData qFetchParameter(DBusMessageIter *it)
     case DBUS_TYPE_ARRAY: {
         int arrayType = dbus_message_iter_get_element_type(it);
 
-        char* sig = dbus_message_iter_get_signature(it);
-        TQCString signature = sig;
-        dbus_free(sig);
+        // arrays of fixed size types are copied as a whole
+        TQT_DBusData::Type fixedType = qFixedTypeForDBusType(arrayType);
+        if (fixedType != TQT_DBusData::Invalid) {
+            DBusMessageIter arrayIt;
+            dbus_message_iter_recurse(it, &arrayIt);
+
+            const void* data = 0;
+            int count = 0;
+            dbus_message_iter_get_fixed_array(&arrayIt, &data, &count);
+
+            return TQT_DBusData::fromList(
+                TQT_DBusMarshall::listFromFixedArray(fixedType, data, count));
+        }
+
+        // the prototype cache is keyed by the array's signature alone
+        char arraySignature[DBUS_MAXIMUM_SIGNATURE_LENGTH + 1];
+        uint length = qSkipSingleType(signature) - signature;
+        if (length > DBUS_MAXIMUM_SIGNATURE_LENGTH) length = DBUS_MAXIMUM_SIGNATURE_LENGTH;
+        memcpy(arraySignature, signature, length);
+        arraySignature[length] = '\0';
 
-        TQValueList<TQT_DBusData> prototypeList = parseSignature(signature);
+        TQT_DBusData prototype = qPrototypeForSignature(arraySignature);
 
         if (arrayType == DBUS_TYPE_DICT_ENTRY) {
             DBusMessageIter sub;
             dbus_message_iter_recurse(it, &sub);
 
-            return qFetchMap(&sub, prototypeList[0]);
+            return qFetchMap(&sub, prototype, signature + 1);
         } else {
-            TQT_DBusDataList list = prototypeList[0].toList();
+            TQT_DBusDataList list = prototype.toList();
 
             DBusMessageIter arrayIt;
             dbus_message_iter_recurse(it, &arrayIt);
 
             while (dbus_message_iter_get_arg_type(&arrayIt) != DBUS_TYPE_INVALID) {
-                list << qFetchParameter(&arrayIt);
+                list << qFetchParameter(&arrayIt, signature + 1);
 
                 dbus_message_iter_next(&arrayIt);
             }
@@ -585,11 +630,12 @@ static TQT_DBusData qFetchParameter(DBusMessageIter *it)
         DBusMessageIter sub;
         dbus_message_iter_recurse(it, &sub);
 
-        char* signature = dbus_message_iter_get_signature(&sub);
-        dvariant.signature = TQString::fromUtf8(signature);
-        dbus_free(signature);
+        // only known to the variant itself
+        char* valueSignature = dbus_message_iter_get_signature(&sub);
+        dvariant.signature = TQString::fromUtf8(valueSignature);
 
-        dvariant.value = qFetchParameter(&sub);
+        dvariant.value = qFetchParameter(&sub, valueSignature);
+        dbus_free(valueSignature);
 
         return TQT_DBusData::fromVariant(dvariant);
     }
@@ -599,9 +645,12 @@ static TQT_DBusData qFetchParameter(DBusMessageIter *it)
         DBusMessageIter subIt;
         dbus_message_iter_recurse(it, &subIt);
 
+        const char* memberSignature = signature + 1;
+
         uint index = 0;
         while (dbus_message_iter_get_arg_type(&subIt) != DBUS_TYPE_INVALID) {
-            memberList << qFetchParameter(&subIt);
+            memberList << qFetchParameter(&subIt, memberSignature);
+            memberSignature = qSkipSingleType(memberSignature);
 
             dbus_message_iter_next(&subIt);
             ++index;
@@ -629,16 +678,34 @@ static TQT_DBusData qFetchParameter(DBusMessageIter *it)
     }
 }
 
-void TQT_DBusMarshall::messageToList(TQValueList<TQT_DBusData>& list, DBusMessage* message)
+TQByteArray TQT_DBusMarshall::fixedArrayData(const TQT_DBusDataList& list)
+{
+    return list.fixedArrayData();
+}
+
+TQT_DBusDataList TQT_DBusMarshall::listFromFixedArray(TQT_DBusData::Type type,
+                                                    const void* data, int count)
+{
+    return TQT_DBusDataList::fromFixedArray(type, data, count);
+}
+
+void TQT_DBusMarshall::messageToList(TQValueList<TQT_DBusData>& list, DBusMessage* message,
+                                     TQT_DBusArena* arena)
 {
     Q_ASSERT(message);
 
     DBusMessageIter it;
     if (!dbus_message_iter_init(message, &it)) return;
 
+    // values created below are allocated from the arena
+    TQT_DBusArena::Scope arenaScope(arena);
+
+    const char* signature = dbus_message_get_signature(message);
+
     do
     {
-        list << qFetchParameter(&it);
+        list << qFetchParameter(&it, signature);
+        signature = qSkipSingleType(signature);
     }
     while (dbus_message_iter_next(&it));
 }
@@ -1137,7 +1204,18 @@ static void qDBusDataToIterator(DBusMessageIter* it, const TQT_DBusData& var)
             dbus_message_iter_open_container(it, DBUS_TYPE_ARRAY,
                                              signature.data(), &sub);
 
-            const TQValueList<TQT_DBusData> valueList = var.toTQValueList();
+            // arrays of fixed size types are appended as a whole
+            const TQByteArray fixedData = TQT_DBusMarshall::fixedArrayData(list);
+            if (!fixedData.isNull())
+            {
+                const char* cdata = fixedData.data();
+                dbus_message_iter_append_fixed_array(&sub, signature[0], &cdata,
+                                                     list.count());
+                dbus_message_iter_close_container(it, &sub);
+                break;
+            }
+
+            const TQValueList<TQT_DBusData> valueList = list.toTQValueList();
             TQValueList<TQT_DBusData>::const_iterator listIt    = valueList.begin();
             TQValueList<TQT_DBusData>::const_iterator listEndIt = valueList.end();
             for (; listIt != listEndIt; ++listIt)
@@ -1252,3 +1330,25 @@ void TQT_DBusMarshall::listToMessage(const TQValueList<TQT_DBusData> &list, DBus
     dbus_message_iter_init_append(msg, &it);
     qListToIterator(&it, list);
 }
+
+bool TQT_DBusMarshall::dataToIterator(const TQT_DBusData& data, DBusMessageIter* it)
+{
+    Q_ASSERT(it);
+    if (!data.isValid()) return false;
+
+    qDBusDataToIterator(it, data);
+    return true;
+}
+
+TQT_DBusData TQT_DBusMarshall::iteratorToData(DBusMessageIter* it)
+{
+    Q_ASSERT(it);
+    if (dbus_message_iter_get_arg_type(it) == DBUS_TYPE_INVALID)
+        return TQT_DBusData();
+
+    char* signature = dbus_message_iter_get_signature(it);
+    TQT_DBusData data = qFetchParameter(it, signature);
+    dbus_free(signature);
+
+    return data;
+}
@@ -24,9 +24,15 @@
 #ifndef TQDBUSMARSHALL_H
 #define TQDBUSMARSHALL_H
 
+#include "tqdbusdata.h"
+
+#include <tqcstring.h>
+
 struct DBusMessage;
+struct DBusMessageIter;
 
-class TQT_DBusData;
+class TQT_DBusArena;
+class TQT_DBusDataList;
 
 template <typename T> class TQValueList;
 
@@ -34,7 +40,21 @@ class TQT_DBusMarshall
 {
 public:
     static void listToMessage(const TQValueList<TQT_DBusData> &list, DBusMessage* message);
-    static void messageToList(TQValueList<TQT_DBusData>& list, DBusMessage* message);
+    static void messageToList(TQValueList<TQT_DBusData>& list, DBusMessage* message,
+                              TQT_DBusArena* arena = 0);
+
+    // single values, e.g. for the converter's fallback of typed marshalling
+    static bool dataToIterator(const TQT_DBusData& data, DBusMessageIter* it);
+    static TQT_DBusData iteratorToData(DBusMessageIter* it);
+
+    // frees the calling thread's caches, to be called before a thread
+    // which de-marshalled messages finishes
+    static void releaseThreadCache();
+
+    // contiguous storage of lists of fixed size types
+    static TQByteArray fixedArrayData(const TQT_DBusDataList& list);
+    static TQT_DBusDataList listFromFixedArray(TQT_DBusData::Type type,
+                                              const void* data, int count);
 };
 
 #endif
@@ -28,11 +28,40 @@
 
 #include <dbus/dbus.h>
 
+#include "tqdbusarena_p.h"
 #include "tqdbusmarshall.h"
 #include "tqdbusmessage_p.h"
+#include "tqdbusstringtable_p.h"
+
+// creates the arena for the message's arguments, sized from their length.
+// libdbus does not tell the length of a message, but the byte length of each
+// array, which makes up nearly all of a large message. The de-marshalled
+// values take several times the bytes of their wire format, except for
+// arrays of fixed size types which are not allocated from the arena
+static TQT_DBusArena* qCreateArena(DBusMessage* dmsg)
+{
+    size_t length = 0;
+
+    DBusMessageIter it;
+    if (dbus_message_iter_init(dmsg, &it))
+    {
+        do
+        {
+            if (dbus_message_iter_get_arg_type(&it) != DBUS_TYPE_ARRAY)
+                length += 8;
+            else if (!dbus_type_is_fixed(dbus_message_iter_get_element_type(&it)))
+                length += dbus_message_iter_get_array_len(&it);
+        }
+        while (dbus_message_iter_next(&it));
+    }
+
+    return new TQT_DBusArena(length * 4);
+}
 
 TQT_DBusMessagePrivate::TQT_DBusMessagePrivate(TQT_DBusMessage *qq)
-    : msg(0), reply(0), q(qq), type(DBUS_MESSAGE_TYPE_INVALID), timeout(-1), ref(1)
+    : msg(0), reply(0), q(qq), type(DBUS_MESSAGE_TYPE_INVALID), timeout(-1),
+      demarshallPending(false), arena(0), outgoing(0), marshalledCount(0),
+      outgoingUsed(false), ref(1)
 {
 }
 
@@ -42,6 +71,12 @@ TQT_DBusMessagePrivate::~TQT_DBusMessagePrivate()
         dbus_message_unref(msg);
     if (reply)
         dbus_message_unref(reply);
+    if (outgoing)
+        dbus_message_unref(outgoing);
+
+    // values still in use elsewhere keep their own reference
+    if (arena)
+        arena->deref();
 }
 
 ///////////////
@@ -107,8 +142,13 @@ TQT_DBusMessage::TQT_DBusMessage()
 }
 
 TQT_DBusMessage::TQT_DBusMessage(const TQT_DBusMessage &other)
-    : TQValueList<TQT_DBusData>(other)
+    : TQValueList<TQT_DBusData>()
 {
+    // each copy has its own argument list, so lazy arguments have to be
+    // de-marshalled before they can be shared
+    if (other.d->demarshallPending) other.demarshallArguments();
+    TQValueList<TQT_DBusData>::operator=(other);
+
     d = other.d;
     d->ref.ref();
 }
@@ -121,6 +161,7 @@ TQT_DBusMessage::~TQT_DBusMessage()
 
 TQT_DBusMessage &TQT_DBusMessage::operator=(const TQT_DBusMessage &other)
 {
+    if (other.d->demarshallPending) other.demarshallArguments();
     TQValueList<TQT_DBusData>::operator=(other);
     // FIXME-QT4 qAtomicAssign(d, other.d);
     if (other.d) other.d->ref.ref();
@@ -131,7 +172,134 @@ TQT_DBusMessage &TQT_DBusMessage::operator=(const TQT_DBusMessage &other)
     return *this;
 }
 
-DBusMessage *TQT_DBusMessage::toDBusMessage() const
+void TQT_DBusMessage::demarshallArguments() const
+{
+    // copying de-marshalls, so this is the only handle of a lazy message
+    d->demarshallPending = false;
+    if (!d->msg) return;
+
+    TQT_DBusMessage* that = const_cast<TQT_DBusMessage*>(this);
+
+    d->arena = qCreateArena(d->msg);
+    TQT_DBusMarshall::messageToList(*that, d->msg, d->arena);
+}
+
+TQT_DBusMessage::iterator TQT_DBusMessage::begin()
+{
+    if (d->demarshallPending) demarshallArguments();
+    return TQValueList<TQT_DBusData>::begin();
+}
+
+TQT_DBusMessage::const_iterator TQT_DBusMessage::begin() const
+{
+    if (d->demarshallPending) demarshallArguments();
+    return TQValueList<TQT_DBusData>::begin();
+}
+
+TQT_DBusMessage::iterator TQT_DBusMessage::end()
+{
+    if (d->demarshallPending) demarshallArguments();
+    return TQValueList<TQT_DBusData>::end();
+}
+
+TQT_DBusMessage::const_iterator TQT_DBusMessage::end() const
+{
+    if (d->demarshallPending) demarshallArguments();
+    return TQValueList<TQT_DBusData>::end();
+}
+
+TQT_DBusMessage::const_iterator TQT_DBusMessage::constBegin() const
+{
+    if (d->demarshallPending) demarshallArguments();
+    return TQValueList<TQT_DBusData>::constBegin();
+}
+
+TQT_DBusMessage::const_iterator TQT_DBusMessage::constEnd() const
+{
+    if (d->demarshallPending) demarshallArguments();
+    return TQValueList<TQT_DBusData>::constEnd();
+}
+
+uint TQT_DBusMessage::count() const
+{
+    if (d->demarshallPending) demarshallArguments();
+    return TQValueList<TQT_DBusData>::count();
+}
+
+TQT_DBusMessage::size_type TQT_DBusMessage::size() const
+{
+    if (d->demarshallPending) demarshallArguments();
+    return TQValueList<TQT_DBusData>::size();
+}
+
+bool TQT_DBusMessage::isEmpty() const
+{
+    if (d->demarshallPending) demarshallArguments();
+    return TQValueList<TQT_DBusData>::isEmpty();
+}
+
+TQT_DBusData& TQT_DBusMessage::operator[](size_type i)
+{
+    if (d->demarshallPending) demarshallArguments();
+    return TQValueList<TQT_DBusData>::operator[](i);
+}
+
+const TQT_DBusData& TQT_DBusMessage::operator[](size_type i) const
+{
+    if (d->demarshallPending) demarshallArguments();
+    return TQValueList<TQT_DBusData>::operator[](i);
+}
+
+TQT_DBusData& TQT_DBusMessage::first()
+{
+    if (d->demarshallPending) demarshallArguments();
+    return TQValueList<TQT_DBusData>::first();
+}
+
+const TQT_DBusData& TQT_DBusMessage::first() const
+{
+    if (d->demarshallPending) demarshallArguments();
+    return TQValueList<TQT_DBusData>::first();
+}
+
+TQT_DBusData& TQT_DBusMessage::last()
+{
+    if (d->demarshallPending) demarshallArguments();
+    return TQValueList<TQT_DBusData>::last();
+}
+
+const TQT_DBusData& TQT_DBusMessage::last() const
+{
+    if (d->demarshallPending) demarshallArguments();
+    return TQValueList<TQT_DBusData>::last();
+}
+
+TQT_DBusMessage &TQT_DBusMessage::operator<<(const TQT_DBusData &data)
+{
+    if (d->demarshallPending) demarshallArguments();
+    TQValueList<TQT_DBusData>::append(data);
+    return *this;
+}
+
+TQT_DBusMessage::iterator TQT_DBusMessage::append(const TQT_DBusData &data)
+{
+    if (d->demarshallPending) demarshallArguments();
+    return TQValueList<TQT_DBusData>::append(data);
+}
+
+TQT_DBusMessage &TQT_DBusMessage::operator+=(const TQValueList<TQT_DBusData> &list)
+{
+    if (d->demarshallPending) demarshallArguments();
+    TQValueList<TQT_DBusData>::operator+=(list);
+    return *this;
+}
+
+bool TQT_DBusMessage::isLazy() const
+{
+    return d->demarshallPending;
+}
+
+DBusMessage *TQT_DBusMessage::createDBusMessage() const
 {
     DBusMessage *msg = 0;
     switch (d->type) {
@@ -152,24 +320,160 @@ DBusMessage *TQT_DBusMessage::toDBusMessage() const
                 d->error.message().utf8().data());
         break;
     }
+
+    return msg;
+}
+
+DBusMessageIter *TQT_DBusMessage::appendIterator()
+{
+    if (d->demarshallPending) demarshallArguments();
+
+    if (!d->outgoing)
+    {
+        d->outgoing = createDBusMessage();
+        if (!d->outgoing)
+            return 0;
+    }
+    else if (d->outgoingUsed)
+    {
+        DBusMessage *copy = dbus_message_copy(d->outgoing);
+        if (!copy)
+            return 0;
+
+        dbus_message_unref(d->outgoing);
+        d->outgoing = copy;
+        d->outgoingUsed = false;
+    }
+
+    // values added as TQT_DBusData before have to stay in front
+    uint listCount = TQValueList<TQT_DBusData>::count();
+    if (listCount > d->marshalledCount)
+    {
+        TQValueList<TQT_DBusData> pending;
+        const_iterator it = TQValueList<TQT_DBusData>::at(d->marshalledCount);
+        for (; it != TQValueList<TQT_DBusData>::end(); ++it)
+            pending.append(*it);
+
+        TQT_DBusMarshall::listToMessage(pending, d->outgoing);
+        d->marshalledCount = listCount;
+    }
+
+    dbus_message_iter_init_append(d->outgoing, &d->appendIter);
+    return &d->appendIter;
+}
+
+DBusMessageIter *TQT_DBusMessage::readIterator(uint index) const
+{
+    if (!d->msg || !dbus_message_iter_init(d->msg, &d->readIter))
+        return 0;
+
+    for (uint i = 0; i < index; ++i)
+    {
+        if (!dbus_message_iter_next(&d->readIter))
+            return 0;
+    }
+
+    return &d->readIter;
+}
+
+DBusMessage *TQT_DBusMessage::toDBusMessage() const
+{
+    if (d->demarshallPending) demarshallArguments();
+
+    if (!d->outgoing)
+    {
+        DBusMessage *msg = createDBusMessage();
+        if (!msg)
+            return 0;
+
+        TQT_DBusMarshall::listToMessage(*this, msg);
+        return msg;
+    }
+
+    uint listCount = TQValueList<TQT_DBusData>::count();
+
+    // the first send can use the already marshalled message itself
+    if (!d->outgoingUsed && listCount <= d->marshalledCount)
+    {
+        d->outgoingUsed = true;
+        return dbus_message_ref(d->outgoing);
+    }
+
+    // the values written by append<T>() are only copied, not marshalled again
+    DBusMessage *msg = dbus_message_copy(d->outgoing);
     if (!msg)
         return 0;
 
-    TQT_DBusMarshall::listToMessage(*this, msg);
+    if (listCount > d->marshalledCount)
+    {
+        TQValueList<TQT_DBusData> pending;
+        const_iterator it = TQValueList<TQT_DBusData>::at(d->marshalledCount);
+        for (; it != TQValueList<TQT_DBusData>::end(); ++it)
+            pending.append(*it);
+
+        TQT_DBusMarshall::listToMessage(pending, msg);
+    }
+
     return msg;
 }
 
-TQT_DBusMessage TQT_DBusMessage::fromDBusMessage(DBusMessage *dmsg)
+TQT_DBusMessage TQT_DBusMessage::fromMarshalled(int type, const TQString &service,
+                                                const TQString &path, const TQString &interface,
+                                                const TQString &member,
+                                                const TQValueList<TQT_DBusData> &arguments,
+                                                DBusMessage *raw)
 {
     TQT_DBusMessage message;
-    if (!dmsg)
-        return message;
+    message.d->type = type;
+    message.d->service = service;
+    message.d->path = path;
+    message.d->interface = interface;
+    message.d->member = member;
+
+    // shares the list's data instead of copying its items
+    message.TQValueList<TQT_DBusData>::operator=(arguments);
+
+    message.d->outgoing = raw;
+    message.d->marshalledCount = arguments.count();
+
+    return message;
+}
+
+TQT_DBusMessage TQT_DBusMessage::fromDBusMessage(DBusMessage *dmsg, bool lazy)
+{
+    return fromDBusMessage(dmsg, lazy, 0);
+}
+
+TQT_DBusMessage TQT_DBusMessage::fromDBusMessage(DBusMessage *dmsg, bool lazy,
+                                                 TQT_DBusStringTable *strings)
+{
+    TQT_DBusMessage message;
+    if (dmsg)
+        message.initFromDBusMessage(dmsg, lazy, strings);
+
+    return message;
+}
+
+void TQT_DBusMessage::initFromDBusMessage(DBusMessage *dmsg, bool lazy,
+                                          TQT_DBusStringTable *strings)
+{
+    TQT_DBusMessage& message = *this;
 
     message.d->type = dbus_message_get_type(dmsg);
-    message.d->path = TQString::fromUtf8(dbus_message_get_path(dmsg));
-    message.d->interface = TQString::fromUtf8(dbus_message_get_interface(dmsg));
-    message.d->member = TQString::fromUtf8(dbus_message_get_member(dmsg));
-    message.d->sender = TQString::fromUtf8(dbus_message_get_sender(dmsg));
+    if (strings != 0)
+    {
+        message.d->path = strings->string(dbus_message_get_path(dmsg));
+        message.d->interface = strings->string(dbus_message_get_interface(dmsg));
+        message.d->member = strings->string(dbus_message_get_member(dmsg));
+        message.d->sender = strings->string(dbus_message_get_sender(dmsg));
+    }
+    else
+    {
+        message.d->path = TQString::fromUtf8(dbus_message_get_path(dmsg));
+        message.d->interface = TQString::fromUtf8(dbus_message_get_interface(dmsg));
+        message.d->member = TQString::fromUtf8(dbus_message_get_member(dmsg));
+        message.d->sender = TQString::fromUtf8(dbus_message_get_sender(dmsg));
+    }
     message.d->msg = dbus_message_ref(dmsg);
 
     DBusError dbusError;
@@ -179,9 +483,13 @@ TQT_DBusMessage TQT_DBusMessage::fromDBusMessage(DBusMessage *dmsg)
         message.d->error = TQT_DBusError(&dbusError);
     }
 
-    TQT_DBusMarshall::messageToList(message, dmsg);
-
-    return message;
+    if (lazy)
+        message.d->demarshallPending = true;
+    else
+    {
+        message.d->arena = qCreateArena(dmsg);
+        TQT_DBusMarshall::messageToList(message, dmsg, message.d->arena);
+    }
 }
 
 TQString TQT_DBusMessage::path() const
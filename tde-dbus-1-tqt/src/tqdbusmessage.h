@@ -27,6 +27,7 @@
 
 #include "tqdbusmacros.h"
 #include "tqdbusdata.h"
+#include "tqdbusdataconverter.h"
 
 #include <tqvaluelist.h>
 
@@ -34,6 +35,7 @@
 
 class TQT_DBusError;
 class TQT_DBusMessagePrivate;
+class TQT_DBusStringTable;
 struct DBusMessage;
 
 /**
@@ -42,6 +44,12 @@ struct DBusMessage;
  * A TQT_DBusMessage is implicitly shared, similar to a TQString, i.e. copying
  * a message creates just a shallow copy.
  *
+ * @note the message's own data and its TQT_DBusData arguments are reference
+ *       counted atomically, however the argument list is a TQValueList, which
+ *       is not. A message can be handed to another thread for processing as
+ *       long as the handing thread does not keep a copy, see TQT_DBusData for
+ *       details.
+ *
  * The TQT_DBusMessage is the TQt3 bindings means of encapsulating data for a
  * method call, a method reply or an error.
  *
@@ -115,6 +123,10 @@ struct DBusMessage;
 class TQDBUS_EXPORT TQT_DBusMessage: public TQValueList<TQT_DBusData>
 {
     friend class TQT_DBusConnection;
+    friend class TQT_DBusConnectionPrivate;
+    friend class TQT_DBusMessageReader;
+    friend class TQT_DBusPreparedCall;
+    friend class TQT_DBusPreparedSignal;
 public:
     /**
      * @brief Anonymous enum for timeout constants
@@ -474,6 +486,125 @@ public:
      */
     int replySerialNumber() const;
 
+    /**
+     * @brief Returns whether the message arguments have not been de-marshalled yet
+     *
+     * Messages created by fromDBusMessage() with @c lazy set to @c true only
+     * keep a reference to the raw D-Bus message. The argument list is
+     * filled on the first access through one of the list accessors of this
+     * class, e.g. count(), begin() or operator[](), or when the message is
+     * copied.
+     *
+     * Signals are received lazily, but they are de-marshalled before they
+     * are delivered to any receiver, so only signals nobody is connected
+     * to skip the conversion. Messages handed to application code are
+     * therefore never lazy and can be used as a plain
+     * TQValueList<TQT_DBusData>.
+     *
+     * @note a lazy message only sees its arguments through the accessors of
+     *       this class, not through the ones of TQValueList<TQT_DBusData>
+     *
+     * @return @c true if the arguments still need to be de-marshalled,
+     *         otherwise @c false
+     */
+    bool isLazy() const;
+
+    // list accessors de-marshalling the arguments of lazy messages first
+    iterator begin();
+    const_iterator begin() const;
+    iterator end();
+    const_iterator end() const;
+    const_iterator constBegin() const;
+    const_iterator constEnd() const;
+
+    uint count() const;
+    size_type size() const;
+    bool isEmpty() const;
+    bool empty() const { return isEmpty(); }
+
+    TQT_DBusData& operator[](size_type i);
+    const TQT_DBusData& operator[](size_type i) const;
+    TQT_DBusData& first();
+    const TQT_DBusData& first() const;
+    TQT_DBusData& last();
+    const TQT_DBusData& last() const;
+
+    TQT_DBusMessage &operator<<(const TQT_DBusData &data);
+    TQT_DBusMessage &operator+=(const TQValueList<TQT_DBusData> &list);
+    iterator append(const TQT_DBusData &data);
+
+    /**
+     * @brief Marshalls a native value straight into the message
+     *
+     * Writes the value with TQT_DBusDataConverter::convertToDBusMessageIter()
+     * instead of converting it into a TQT_DBusData instance which would be
+     * marshalled again when the message is sent.
+     *
+     * Example:
+     * @code
+     * TQT_DBusMessage message = TQT_DBusMessage::signal(path, interface, "Moved");
+     * message.append<TQPoint>(position);
+     * message.append<TQString>(name);
+     * @endcode
+     *
+     * Values appended this way keep their order relative to the ones added
+     * as TQT_DBusData, but they are not part of the message's argument list,
+     * i.e. count() and operator[]() do not see them.
+     *
+     * @note copies of the message share the values appended this way,
+     *       so append all values before copying the message
+     *
+     * @param value the value to marshall
+     *
+     * @return the conversion result, TQT_DBusDataConverter::InvalidArgument
+     *         if the message is an #InvalidMessage
+     *
+     * @see read()
+     */
+    template <class T>
+    TQT_DBusDataConverter::Result append(const T& value)
+    {
+        DBusMessageIter* iter = appendIterator();
+        if (iter == 0) return TQT_DBusDataConverter::InvalidArgument;
+
+        return TQT_DBusDataConverter::convertToDBusMessageIter<T>(value, iter);
+    }
+
+    /**
+     * @brief De-marshalls an argument of a received message straight into
+     *        a native value
+     *
+     * Reads the value with TQT_DBusDataConverter::convertFromDBusMessageIter()
+     * from the raw D-Bus message. This does not de-marshall a lazy message's
+     * argument list, see isLazy().
+     *
+     * Example:
+     * @code
+     * TQPoint position;
+     * if (message.read<TQPoint>(0, position) != TQT_DBusDataConverter::Success)
+     * {
+     *     // error handling
+     * }
+     * @endcode
+     *
+     * @param index the position of the argument in the message
+     * @param value the value to de-marshall into
+     *
+     * @return the conversion result, TQT_DBusDataConverter::InvalidSignature
+     *         if the message has no argument at @p index or has not been
+     *         received from D-Bus
+     *
+     * @see append()
+     */
+    template <class T>
+    TQT_DBusDataConverter::Result read(uint index, T& value) const
+    {
+        DBusMessageIter* iter = readIterator(index);
+        if (iter == 0) return TQT_DBusDataConverter::InvalidSignature;
+
+        return TQT_DBusDataConverter::convertFromDBusMessageIter<T>(iter, value);
+    }
+
 //protected:
     /**
      * @brief Creates a raw D-Bus message from this TQt3-bindings message
@@ -499,12 +630,42 @@ public:
      *       counter and will still have access to the raw message even if the
      *       caller "deleted" it using dbus_message_unref()
      *
+     * If @p lazy is @c true, de-marshalling is deferred until the arguments
+     * are accessed for the first time or the message is copied, see
+     * isLazy(). Messages which are dropped without looking at their
+     * arguments therefore never pay for the conversion.
+     *
      * @param dmsg a C API D-Bus message
+     * @param lazy whether to defer de-marshalling of the arguments
      *
      * @return a TQt3 bindings message. Can be an #InvalidMessage if the given
      *         message was @c 0 or if de-marshalling failed
      */
-    static TQT_DBusMessage fromDBusMessage(DBusMessage *dmsg);
+    static TQT_DBusMessage fromDBusMessage(DBusMessage *dmsg, bool lazy = false);
+
+private:
+    void demarshallArguments() const;
+
+    DBusMessage *createDBusMessage() const;
+    DBusMessageIter *appendIterator();
+    DBusMessageIter *readIterator(uint index) const;
+
+    // a message whose arguments have already been marshalled into raw,
+    // takes ownership of raw
+    static TQT_DBusMessage fromMarshalled(int type, const TQString &service,
+                                          const TQString &path, const TQString &interface,
+                                          const TQString &member,
+                                          const TQValueList<TQT_DBusData> &arguments,
+                                          DBusMessage *raw);
+
+    // like the public one, taking the header fields from the connection's
+    // intern table if there is one
+    static TQT_DBusMessage fromDBusMessage(DBusMessage *dmsg, bool lazy,
+                                           TQT_DBusStringTable *strings);
+
+    // fills a default constructed message, keeps it lazy without a copy
+    void initFromDBusMessage(DBusMessage *dmsg, bool lazy,
+                             TQT_DBusStringTable *strings);
 
 private:
     TQT_DBusMessagePrivate *d;
@@ -26,11 +26,15 @@
 #define TQDBUSMESSAGE_P_H
 
 #include <tqstring.h>
+#include <tqvaluelist.h>
 
 #include "tqdbusatomic.h"
+#include "tqdbusdata.h"
 #include "tqdbuserror.h"
 
-struct DBusMessage;
+#include <dbus/dbus.h>
+
+class TQT_DBusArena;
 
 class TQT_DBusMessagePrivate
 {
@@ -45,6 +49,24 @@ public:
     TQT_DBusMessage *q;
     int type;
     int timeout;
+
+    // the arguments of a lazily created message are de-marshalled on first
+    // access through TQT_DBusMessage or when the message is copied
+    bool demarshallPending;
+
+    // storage of the de-marshalled argument values
+    TQT_DBusArena* arena;
+
+    // raw message holding the arguments written by TQT_DBusMessage::append<T>(),
+    // preceded by the first marshalledCount values of the argument list
+    DBusMessage *outgoing;
+    uint marshalledCount;
+
+    // outgoing has been handed out by toDBusMessage() and is locked once sent
+    bool outgoingUsed;
+    DBusMessageIter appendIter;
+    DBusMessageIter readIter;
+
     // FIXME-QT4 TQAtomic ref;
     Atomic ref;
 };
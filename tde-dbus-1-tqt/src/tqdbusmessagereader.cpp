@@ -0,0 +1,395 @@
+/* tqdbusmessagereader.cpp cursor over the arguments of a received message
+ *
+ * Licensed under the Academic Free License version 2.1
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ *
+ */
+
+#include "tqdbusmessagereader.h"
+
+#include "tqdbusmarshall.h"
+#include "tqdbusmessage.h"
+#include "tqdbusmessage_p.h"
+#include "tqdbusobjectpath.h"
+
+#include <tqstring.h>
+
+#include <dbus/dbus.h>
+
+class TQT_DBusMessageReader::Private
+{
+public:
+    // libdbus limits messages to 32 levels of arrays plus 32 of structs
+    enum { MaxDepth = 64 };
+
+    struct Level
+    {
+        DBusMessageIter iter;  // the values, or the entries of a map
+        DBusMessageIter entry; // key and value of the current map entry
+        bool map;
+    };
+
+    Private() : message(0), noArguments(true), depth(0) {}
+
+    ~Private()
+    {
+        if (message != 0) dbus_message_unref(message);
+    }
+
+    DBusMessageIter* current()
+    {
+        Level& level = levels[depth];
+        return level.map ? &level.entry : &level.iter;
+    }
+
+    int currentType()
+    {
+        if (message == 0 || (depth == 0 && noArguments))
+            return DBUS_TYPE_INVALID;
+
+        Level& level = levels[depth];
+        if (level.map && dbus_message_iter_get_arg_type(&level.iter) != DBUS_TYPE_DICT_ENTRY)
+            return DBUS_TYPE_INVALID;
+
+        return dbus_message_iter_get_arg_type(current());
+    }
+
+    bool advance()
+    {
+        if (currentType() == DBUS_TYPE_INVALID) return false;
+
+        Level& level = levels[depth];
+        if (!level.map)
+            return dbus_message_iter_next(&level.iter);
+
+        // from the key to the value, or on to the next entry
+        if (dbus_message_iter_next(&level.entry)) return true;
+
+        if (!dbus_message_iter_next(&level.iter)) return false;
+
+        dbus_message_iter_recurse(&level.iter, &level.entry);
+        return true;
+    }
+
+    template <typename T>
+    bool readBasic(int dbusType, T& value)
+    {
+        if (currentType() != dbusType) return false;
+
+        dbus_message_iter_get_basic(current(), &value);
+        advance();
+        return true;
+    }
+
+    const void* fixedArray(int& count)
+    {
+        count = -1;
+        if (currentType() != DBUS_TYPE_ARRAY) return 0;
+
+        int elementType = dbus_message_iter_get_element_type(current());
+        if (!dbus_type_is_fixed(elementType) || elementType == DBUS_TYPE_UNIX_FD)
+            return 0;
+
+        DBusMessageIter elements;
+        dbus_message_iter_recurse(current(), &elements);
+
+        const void* data = 0;
+        dbus_message_iter_get_fixed_array(&elements, &data, &count);
+
+        return data;
+    }
+
+public:
+    DBusMessage* message;
+    bool noArguments;
+
+    Level levels[MaxDepth + 1];
+    uint depth;
+};
+
+TQT_DBusMessageReader::TQT_DBusMessageReader(const TQT_DBusMessage& message)
+    : d(new Private())
+{
+    d->levels[0].map = false;
+
+    if (message.d->msg == 0) return;
+
+    d->message = dbus_message_ref(message.d->msg);
+    d->noArguments = !dbus_message_iter_init(d->message, &d->levels[0].iter);
+}
+
+TQT_DBusMessageReader::~TQT_DBusMessageReader()
+{
+    delete d;
+}
+
+bool TQT_DBusMessageReader::isValid() const
+{
+    return d->message != 0;
+}
+
+bool TQT_DBusMessageReader::atEnd() const
+{
+    return d->currentType() == DBUS_TYPE_INVALID;
+}
+
+TQT_DBusData::Type TQT_DBusMessageReader::type() const
+{
+    switch (d->currentType())
+    {
+        case DBUS_TYPE_BOOLEAN:
+            return TQT_DBusData::Bool;
+        case DBUS_TYPE_BYTE:
+            return TQT_DBusData::Byte;
+        case DBUS_TYPE_INT16:
+            return TQT_DBusData::Int16;
+        case DBUS_TYPE_UINT16:
+            return TQT_DBusData::UInt16;
+        case DBUS_TYPE_INT32:
+            return TQT_DBusData::Int32;
+        case DBUS_TYPE_UINT32:
+            return TQT_DBusData::UInt32;
+        case DBUS_TYPE_INT64:
+            return TQT_DBusData::Int64;
+        case DBUS_TYPE_UINT64:
+            return TQT_DBusData::UInt64;
+        case DBUS_TYPE_DOUBLE:
+            return TQT_DBusData::Double;
+        case DBUS_TYPE_STRING:
+        case DBUS_TYPE_SIGNATURE:
+            return TQT_DBusData::String;
+        case DBUS_TYPE_OBJECT_PATH:
+            return TQT_DBusData::ObjectPath;
+        case DBUS_TYPE_UNIX_FD:
+            return TQT_DBusData::UnixFd;
+        case DBUS_TYPE_ARRAY:
+            if (dbus_message_iter_get_element_type(d->current()) == DBUS_TYPE_DICT_ENTRY)
+                return TQT_DBusData::Map;
+            return TQT_DBusData::List;
+        case DBUS_TYPE_STRUCT:
+            return TQT_DBusData::Struct;
+        case DBUS_TYPE_VARIANT:
+            return TQT_DBusData::Variant;
+        default:
+            return TQT_DBusData::Invalid;
+    }
+}
+
+TQCString TQT_DBusMessageReader::signature() const
+{
+    if (d->currentType() == DBUS_TYPE_INVALID) return TQCString();
+
+    char* signature = dbus_message_iter_get_signature(d->current());
+    TQCString result(signature);
+    dbus_free(signature);
+
+    return result;
+}
+
+uint TQT_DBusMessageReader::depth() const
+{
+    return d->depth;
+}
+
+bool TQT_DBusMessageReader::next()
+{
+    return d->advance();
+}
+
+bool TQT_DBusMessageReader::enterContainer()
+{
+    int dbusType = d->currentType();
+    if (d->depth >= Private::MaxDepth) return false;
+
+    DBusMessageIter* it = d->current();
+    Private::Level& child = d->levels[d->depth + 1];
+    child.map = false;
+
+    switch (dbusType)
+    {
+        case DBUS_TYPE_ARRAY:
+            child.map = dbus_message_iter_get_element_type(it) == DBUS_TYPE_DICT_ENTRY;
+            break;
+        case DBUS_TYPE_STRUCT:
+        case DBUS_TYPE_VARIANT:
+            break;
+        default:
+            return false;
+    }
+
+    dbus_message_iter_recurse(it, &child.iter);
+    if (child.map && dbus_message_iter_get_arg_type(&child.iter) == DBUS_TYPE_DICT_ENTRY)
+        dbus_message_iter_recurse(&child.iter, &child.entry);
+
+    ++d->depth;
+    return true;
+}
+
+bool TQT_DBusMessageReader::leaveContainer()
+{
+    if (d->depth == 0) return false;
+
+    // the parent is still positioned on the container
+    --d->depth;
+    d->advance();
+
+    return true;
+}
+
+int TQT_DBusMessageReader::fixedArrayCount() const
+{
+    int count = -1;
+    d->fixedArray(count);
+
+    return count;
+}
+
+const void* TQT_DBusMessageReader::fixedArray(int& count)
+{
+    const void* data = d->fixedArray(count);
+    if (count >= 0) d->advance();
+
+    return data;
+}
+
+bool TQT_DBusMessageReader::readBool(bool& value)
+{
+    dbus_bool_t dbusValue = false;
+    if (!d->readBasic(DBUS_TYPE_BOOLEAN, dbusValue)) return false;
+
+    value = dbusValue;
+    return true;
+}
+
+bool TQT_DBusMessageReader::readByte(TQ_UINT8& value)
+{
+    unsigned char dbusValue = 0;
+    if (!d->readBasic(DBUS_TYPE_BYTE, dbusValue)) return false;
+
+    value = dbusValue;
+    return true;
+}
+
+bool TQT_DBusMessageReader::readInt16(TQ_INT16& value)
+{
+    dbus_int16_t dbusValue = 0;
+    if (!d->readBasic(DBUS_TYPE_INT16, dbusValue)) return false;
+
+    value = dbusValue;
+    return true;
+}
+
+bool TQT_DBusMessageReader::readUInt16(TQ_UINT16& value)
+{
+    dbus_uint16_t dbusValue = 0;
+    if (!d->readBasic(DBUS_TYPE_UINT16, dbusValue)) return false;
+
+    value = dbusValue;
+    return true;
+}
+
+bool TQT_DBusMessageReader::readInt32(TQ_INT32& value)
+{
+    dbus_int32_t dbusValue = 0;
+    if (!d->readBasic(DBUS_TYPE_INT32, dbusValue)) return false;
+
+    value = dbusValue;
+    return true;
+}
+
+bool TQT_DBusMessageReader::readUInt32(TQ_UINT32& value)
+{
+    dbus_uint32_t dbusValue = 0;
+    if (!d->readBasic(DBUS_TYPE_UINT32, dbusValue)) return false;
+
+    value = dbusValue;
+    return true;
+}
+
+bool TQT_DBusMessageReader::readInt64(TQ_INT64& value)
+{
+    dbus_int64_t dbusValue = 0;
+    if (!d->readBasic(DBUS_TYPE_INT64, dbusValue)) return false;
+
+    value = dbusValue;
+    return true;
+}
+
+bool TQT_DBusMessageReader::readUInt64(TQ_UINT64& value)
+{
+    dbus_uint64_t dbusValue = 0;
+    if (!d->readBasic(DBUS_TYPE_UINT64, dbusValue)) return false;
+
+    value = dbusValue;
+    return true;
+}
+
+bool TQT_DBusMessageReader::readDouble(double& value)
+{
+    return d->readBasic(DBUS_TYPE_DOUBLE, value);
+}
+
+bool TQT_DBusMessageReader::readString(TQString& value)
+{
+    int dbusType = d->currentType();
+    if (dbusType != DBUS_TYPE_STRING && dbusType != DBUS_TYPE_SIGNATURE)
+        return false;
+
+    const char* string = 0;
+    dbus_message_iter_get_basic(d->current(), &string);
+    value = TQString::fromUtf8(string);
+
+    d->advance();
+    return true;
+}
+
+bool TQT_DBusMessageReader::readObjectPath(TQT_DBusObjectPath& value)
+{
+    const char* path = 0;
+    if (!d->readBasic(DBUS_TYPE_OBJECT_PATH, path)) return false;
+
+    value = TQT_DBusObjectPath(TQString::fromUtf8(path));
+    return true;
+}
+
+const char* TQT_DBusMessageReader::stringData() const
+{
+    switch (d->currentType())
+    {
+        case DBUS_TYPE_STRING:
+        case DBUS_TYPE_SIGNATURE:
+        case DBUS_TYPE_OBJECT_PATH:
+            break;
+        default:
+            return 0;
+    }
+
+    const char* string = 0;
+    dbus_message_iter_get_basic(d->current(), &string);
+
+    return string;
+}
+
+TQT_DBusData TQT_DBusMessageReader::readData()
+{
+    if (d->currentType() == DBUS_TYPE_INVALID) return TQT_DBusData();
+
+    TQT_DBusData data = TQT_DBusMarshall::iteratorToData(d->current());
+    d->advance();
+
+    return data;
+}
@@ -0,0 +1,351 @@
+/* tqdbusmessagereader.h cursor over the arguments of a received message
+ *
+ * Licensed under the Academic Free License version 2.1
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ *
+ */
+
+#ifndef TQDBUSMESSAGEREADER_H
+#define TQDBUSMESSAGEREADER_H
+
+#include "tqdbusmacros.h"
+#include "tqdbusdata.h"
+
+#include <tqcstring.h>
+#include <tqglobal.h>
+
+class TQString;
+class TQT_DBusMessage;
+class TQT_DBusObjectPath;
+
+/**
+ * @brief Reads the arguments of a received message one value at a time
+ *
+ * TQT_DBusMessage converts all arguments of a message into TQT_DBusData
+ * objects, including every element of every container. For large replies
+ * where only a few values are of interest, or which can be processed one
+ * element after the other, TQT_DBusMessageReader instead walks over the
+ * raw message data without building that tree.
+ *
+ * The reader is a cursor on the current value. Basic values are read
+ * with the typed read methods which move the cursor to the next value.
+ * Containers, i.e. lists, maps, structs and variants, can either be
+ * skipped as a whole with next(), converted as a whole with readData() or
+ * entered with enterContainer() to read their contents.
+ *
+ * Inside a map the keys and values alternate, i.e. each key is followed
+ * by its value.
+ *
+ * @code
+ *   // reply of a method returning a(ss), only the second member of each
+ *   // struct is used
+ *   TQT_DBusMessageReader reader(reply);
+ *
+ *   if (reader.enterContainer()) // the list
+ *   {
+ *       while (!reader.atEnd())
+ *       {
+ *           reader.enterContainer(); // the struct
+ *           reader.next();           // skip the first member
+ *
+ *           TQString name;
+ *           reader.readString(name);
+ *           handleName(name);
+ *
+ *           reader.leaveContainer();
+ *       }
+ *       reader.leaveContainer();
+ *   }
+ * @endcode
+ *
+ * The reader works on the raw D-Bus message. It neither de-marshalls the
+ * message's argument list nor creates TQT_DBusData objects, except for
+ * readData().
+ *
+ * @note only messages received from D-Bus can be read, i.e. the ones
+ *       created by TQT_DBusMessage::fromDBusMessage()
+ */
+class TQDBUS_EXPORT TQT_DBusMessageReader
+{
+public:
+    /**
+     * @brief Creates a reader positioned on the message's first argument
+     *
+     * @param message the message to read. The reader keeps a reference of
+     *        the underlying D-Bus message, so @p message can be destroyed
+     *        before the reader
+     */
+    TQT_DBusMessageReader(const TQT_DBusMessage& message);
+
+    /**
+     * @brief Destroys the reader
+     */
+    ~TQT_DBusMessageReader();
+
+    /**
+     * @brief Returns whether there is message data to read
+     *
+     * @return @c false if the message has not been received from D-Bus,
+     *         otherwise @c true
+     */
+    bool isValid() const;
+
+    /**
+     * @brief Returns whether the cursor is behind the last value
+     *
+     * Applies to the current level, i.e. to the contents of the innermost
+     * container entered with enterContainer() or to the message's
+     * arguments.
+     *
+     * @return @c true if there is no current value, otherwise @c false
+     */
+    bool atEnd() const;
+
+    /**
+     * @brief Returns the type of the current value
+     *
+     * @return the type of the value at the cursor or TQT_DBusData::Invalid
+     *         if atEnd()
+     */
+    TQT_DBusData::Type type() const;
+
+    /**
+     * @brief Returns the D-Bus signature of the current value
+     *
+     * @return the signature or an empty string if atEnd()
+     */
+    TQCString signature() const;
+
+    /**
+     * @brief Returns the number of containers the cursor is in
+     *
+     * @return @c 0 on the level of the message's arguments
+     */
+    uint depth() const;
+
+    /**
+     * @brief Moves the cursor to the next value
+     *
+     * Containers are skipped as a whole without converting any of their
+     * contents.
+     *
+     * @return @c true if there is a next value, @c false if the cursor is
+     *         now atEnd()
+     */
+    bool next();
+
+    /**
+     * @brief Moves the cursor into the current container value
+     *
+     * The cursor is positioned on the container's first value, or at its
+     * end if the container is empty.
+     *
+     * @return @c false if the current value is not a list, map, struct or
+     *         variant, otherwise @c true
+     *
+     * @see leaveContainer()
+     */
+    bool enterContainer();
+
+    /**
+     * @brief Moves the cursor out of the current container
+     *
+     * The values of the container not read yet are skipped and the cursor
+     * is positioned on the value following the container.
+     *
+     * @return @c false if depth() is @c 0, otherwise @c true
+     *
+     * @see enterContainer()
+     */
+    bool leaveContainer();
+
+    /**
+     * @brief Returns the number of elements of the current list
+     *
+     * Only available for lists of fixed size types, i.e. of bool, numbers
+     * and doubles, for which it does not need to look at the elements.
+     *
+     * @return the number of elements or @c -1 if the current value is not
+     *         a list of one of these types
+     *
+     * @see fixedArray()
+     */
+    int fixedArrayCount() const;
+
+    /**
+     * @brief Returns the elements of the current list in place
+     *
+     * Only available for lists of fixed size types, i.e. of bool, numbers
+     * and doubles. The returned data is the message's own buffer in host
+     * byte order, e.g. an array of @c TQ_INT32 for a list of
+     * TQT_DBusData::Int32 values. Booleans are 32-bit values.
+     *
+     * The cursor is moved to the next value.
+     *
+     * @param count used to return the number of elements
+     *
+     * @return a pointer to the elements, valid as long as the reader exists,
+     *         or @c 0 if the current value is not a list of a fixed size
+     *         type
+     */
+    const void* fixedArray(int& count);
+
+    /**
+     * @brief Reads a boolean value and moves to the next value
+     *
+     * @param value used to return the value
+     *
+     * @return @c false if the current value is not a TQT_DBusData::Bool,
+     *         otherwise @c true
+     */
+    bool readBool(bool& value);
+
+    /**
+     * @brief Reads a byte value and moves to the next value
+     *
+     * @param value used to return the value
+     *
+     * @return @c false if the current value is not a TQT_DBusData::Byte,
+     *         otherwise @c true
+     */
+    bool readByte(TQ_UINT8& value);
+
+    /**
+     * @brief Reads a signed 16-bit integer value and moves to the next value
+     *
+     * @param value used to return the value
+     *
+     * @return @c false if the current value is not a TQT_DBusData::Int16,
+     *         otherwise @c true
+     */
+    bool readInt16(TQ_INT16& value);
+
+    /**
+     * @brief Reads an unsigned 16-bit integer value and moves to the next value
+     *
+     * @param value used to return the value
+     *
+     * @return @c false if the current value is not a TQT_DBusData::UInt16,
+     *         otherwise @c true
+     */
+    bool readUInt16(TQ_UINT16& value);
+
+    /**
+     * @brief Reads a signed 32-bit integer value and moves to the next value
+     *
+     * @param value used to return the value
+     *
+     * @return @c false if the current value is not a TQT_DBusData::Int32,
+     *         otherwise @c true
+     */
+    bool readInt32(TQ_INT32& value);
+
+    /**
+     * @brief Reads an unsigned 32-bit integer value and moves to the next value
+     *
+     * @param value used to return the value
+     *
+     * @return @c false if the current value is not a TQT_DBusData::UInt32,
+     *         otherwise @c true
+     */
+    bool readUInt32(TQ_UINT32& value);
+
+    /**
+     * @brief Reads a signed 64-bit integer value and moves to the next value
+     *
+     * @param value used to return the value
+     *
+     * @return @c false if the current value is not a TQT_DBusData::Int64,
+     *         otherwise @c true
+     */
+    bool readInt64(TQ_INT64& value);
+
+    /**
+     * @brief Reads an unsigned 64-bit integer value and moves to the next value
+     *
+     * @param value used to return the value
+     *
+     * @return @c false if the current value is not a TQT_DBusData::UInt64,
+     *         otherwise @c true
+     */
+    bool readUInt64(TQ_UINT64& value);
+
+    /**
+     * @brief Reads a double value and moves to the next value
+     *
+     * @param value used to return the value
+     *
+     * @return @c false if the current value is not a TQT_DBusData::Double,
+     *         otherwise @c true
+     */
+    bool readDouble(double& value);
+
+    /**
+     * @brief Reads a string value and moves to the next value
+     *
+     * @param value used to return the value
+     *
+     * @return @c false if the current value is not a TQT_DBusData::String,
+     *         otherwise @c true
+     *
+     * @see stringData()
+     */
+    bool readString(TQString& value);
+
+    /**
+     * @brief Reads an object path value and moves to the next value
+     *
+     * @param value used to return the value
+     *
+     * @return @c false if the current value is not a
+     *         TQT_DBusData::ObjectPath, otherwise @c true
+     */
+    bool readObjectPath(TQT_DBusObjectPath& value);
+
+    /**
+     * @brief Returns the UTF-8 encoded current string value in place
+     *
+     * Unlike readString() this does neither convert nor copy the string
+     * and does not move the cursor, e.g. for comparing it to a known value
+     * before deciding whether to read or skip the rest.
+     *
+     * @return the message's own copy of the string, valid as long as the
+     *         reader exists, or @c 0 if the current value is not a
+     *         TQT_DBusData::String or TQT_DBusData::ObjectPath
+     */
+    const char* stringData() const;
+
+    /**
+     * @brief Converts the current value and moves to the next value
+     *
+     * Containers are converted as a whole, same as TQT_DBusMessage does
+     * for its arguments.
+     *
+     * @return the converted value or an invalid TQT_DBusData if atEnd()
+     */
+    TQT_DBusData readData();
+
+private:
+    class Private;
+    Private* d;
+
+    // not copyable
+    TQT_DBusMessageReader(const TQT_DBusMessageReader&);
+    TQT_DBusMessageReader& operator=(const TQT_DBusMessageReader&);
+};
+
+#endif
@@ -0,0 +1,290 @@
+/* tqdbuspreparedcall.cpp method calls and signals with a fixed header
+ *
+ * Licensed under the Academic Free License version 2.1
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ *
+ */
+
+#include "tqdbuspreparedcall.h"
+
+#include "tqdbusconnection.h"
+#include "tqdbusdata.h"
+#include "tqdbuserror.h"
+#include "tqdbusmarshall.h"
+
+#include <dbus/dbus.h>
+
+// an empty signature accepts any arguments
+static bool checkSignature(const TQCString& signature, const char* what)
+{
+    if (signature.isEmpty()) return true;
+
+    if (!dbus_signature_validate(signature.data(), 0))
+    {
+        tqWarning("%s: invalid signature \"%s\"", what, signature.data());
+        return false;
+    }
+
+    return true;
+}
+
+// copies the template and marshalls the arguments into the copy
+static DBusMessage* messageFromTemplate(DBusMessage* templ, const TQCString& signature,
+                                        const TQValueList<TQT_DBusData>& args,
+                                        const char* what)
+{
+    if (templ == 0) return 0;
+
+    DBusMessage* msg = dbus_message_copy(templ);
+    if (msg == 0) return 0;
+
+    TQT_DBusMarshall::listToMessage(args, msg);
+
+    if (!signature.isEmpty() && !dbus_message_has_signature(msg, signature.data()))
+    {
+        tqWarning("%s: arguments have signature \"%s\", expected \"%s\"", what,
+                  dbus_message_get_signature(msg), signature.data());
+
+        dbus_message_unref(msg);
+        return 0;
+    }
+
+    return msg;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+class TQT_DBusPreparedCall::Private
+{
+public:
+    Private() : templ(0), timeout(TQT_DBusMessage::DefaultTimeout) {}
+
+    ~Private()
+    {
+        if (templ != 0) dbus_message_unref(templ);
+    }
+
+    TQT_DBusConnection connection;
+
+    TQString service;
+    TQString path;
+    TQString interface;
+    TQString method;
+    TQCString signature;
+
+    // header only, encoded once
+    DBusMessage* templ;
+
+    int timeout;
+};
+
+TQT_DBusPreparedCall::TQT_DBusPreparedCall(const TQT_DBusConnection& connection,
+                                           const TQString& service, const TQString& path,
+                                           const TQString& interface, const TQString& method,
+                                           const TQCString& signature)
+    : d(new Private())
+{
+    d->connection = connection;
+    d->service    = service;
+    d->path       = path;
+    d->interface  = interface;
+    d->method     = method;
+    d->signature  = signature;
+
+    if (!checkSignature(signature, "TQT_DBusPreparedCall")) return;
+
+    // libdbus asserts on invalid names, so check them first
+    const TQCString serviceName   = service.utf8();
+    const TQCString pathName      = path.utf8();
+    const TQCString interfaceName = interface.utf8();
+    const TQCString methodName    = method.utf8();
+
+    if ((!serviceName.isEmpty() && !dbus_validate_bus_name(serviceName.data(), 0)) ||
+        !dbus_validate_path(pathName.data(), 0) ||
+        (!interfaceName.isEmpty() && !dbus_validate_interface(interfaceName.data(), 0)) ||
+        !dbus_validate_member(methodName.data(), 0))
+    {
+        tqWarning("TQT_DBusPreparedCall: invalid header for method call %s.%s on %s",
+                  interfaceName.data(), methodName.data(), pathName.data());
+        return;
+    }
+
+    d->templ = dbus_message_new_method_call(serviceName.isEmpty() ? 0 : serviceName.data(),
+                                            pathName.data(),
+                                            interfaceName.isEmpty() ? 0 : interfaceName.data(),
+                                            methodName.data());
+}
+
+TQT_DBusPreparedCall::~TQT_DBusPreparedCall()
+{
+    delete d;
+}
+
+bool TQT_DBusPreparedCall::isValid() const
+{
+    return d->templ != 0;
+}
+
+TQCString TQT_DBusPreparedCall::signature() const
+{
+    return d->signature;
+}
+
+void TQT_DBusPreparedCall::setTimeout(int ms)
+{
+    d->timeout = ms;
+}
+
+int TQT_DBusPreparedCall::timeout() const
+{
+    return d->timeout;
+}
+
+TQT_DBusMessage TQT_DBusPreparedCall::message(const TQValueList<TQT_DBusData>& args) const
+{
+    DBusMessage* msg = messageFromTemplate(d->templ, d->signature, args,
+                                           "TQT_DBusPreparedCall");
+    if (msg == 0) return TQT_DBusMessage();
+
+    TQT_DBusMessage message =
+        TQT_DBusMessage::fromMarshalled(DBUS_MESSAGE_TYPE_METHOD_CALL,
+                                        d->service, d->path, d->interface, d->method,
+                                        args, msg);
+    message.setTimeout(d->timeout);
+
+    return message;
+}
+
+bool TQT_DBusPreparedCall::send(const TQValueList<TQT_DBusData>& args) const
+{
+    TQT_DBusMessage call = message(args);
+    if (call.type() == TQT_DBusMessage::InvalidMessage) return false;
+
+    return d->connection.send(call);
+}
+
+TQT_DBusMessage TQT_DBusPreparedCall::sendWithReply(const TQValueList<TQT_DBusData>& args,
+                                                  TQT_DBusError* error) const
+{
+    TQT_DBusMessage call = message(args);
+    if (call.type() == TQT_DBusMessage::InvalidMessage)
+    {
+        if (error != 0)
+            *error = TQT_DBusError::stdInvalidArgs("Arguments do not match the prepared call");
+
+        return TQT_DBusMessage();
+    }
+
+    return d->connection.sendWithReply(call, error);
+}
+
+int TQT_DBusPreparedCall::sendWithAsyncReply(const TQValueList<TQT_DBusData>& args,
+                                             TQObject* receiver, const char* slot) const
+{
+    TQT_DBusMessage call = message(args);
+    if (call.type() == TQT_DBusMessage::InvalidMessage) return 0;
+
+    return d->connection.sendWithAsyncReply(call, receiver, slot);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+class TQT_DBusPreparedSignal::Private
+{
+public:
+    Private() : templ(0) {}
+
+    ~Private()
+    {
+        if (templ != 0) dbus_message_unref(templ);
+    }
+
+    TQT_DBusConnection connection;
+
+    TQString path;
+    TQString interface;
+    TQString member;
+    TQCString signature;
+
+    // header only, encoded once
+    DBusMessage* templ;
+};
+
+TQT_DBusPreparedSignal::TQT_DBusPreparedSignal(const TQT_DBusConnection& connection,
+                                               const TQString& path, const TQString& interface,
+                                               const TQString& member,
+                                               const TQCString& signature)
+    : d(new Private())
+{
+    d->connection = connection;
+    d->path       = path;
+    d->interface  = interface;
+    d->member     = member;
+    d->signature  = signature;
+
+    if (!checkSignature(signature, "TQT_DBusPreparedSignal")) return;
+
+    const TQCString pathName      = path.utf8();
+    const TQCString interfaceName = interface.utf8();
+    const TQCString memberName    = member.utf8();
+
+    if (!dbus_validate_path(pathName.data(), 0) ||
+        !dbus_validate_interface(interfaceName.data(), 0) ||
+        !dbus_validate_member(memberName.data(), 0))
+    {
+        tqWarning("TQT_DBusPreparedSignal: invalid header for signal %s.%s on %s",
+                  interfaceName.data(), memberName.data(), pathName.data());
+        return;
+    }
+
+    d->templ = dbus_message_new_signal(pathName.data(), interfaceName.data(),
+                                       memberName.data());
+}
+
+TQT_DBusPreparedSignal::~TQT_DBusPreparedSignal()
+{
+    delete d;
+}
+
+bool TQT_DBusPreparedSignal::isValid() const
+{
+    return d->templ != 0;
+}
+
+TQCString TQT_DBusPreparedSignal::signature() const
+{
+    return d->signature;
+}
+
+TQT_DBusMessage TQT_DBusPreparedSignal::message(const TQValueList<TQT_DBusData>& args) const
+{
+    DBusMessage* msg = messageFromTemplate(d->templ, d->signature, args,
+                                           "TQT_DBusPreparedSignal");
+    if (msg == 0) return TQT_DBusMessage();
+
+    return TQT_DBusMessage::fromMarshalled(DBUS_MESSAGE_TYPE_SIGNAL,
+                                           TQString(), d->path, d->interface, d->member,
+                                           args, msg);
+}
+
+bool TQT_DBusPreparedSignal::send(const TQValueList<TQT_DBusData>& args) const
+{
+    TQT_DBusMessage signal = message(args);
+    if (signal.type() == TQT_DBusMessage::InvalidMessage) return false;
+
+    return d->connection.send(signal);
+}
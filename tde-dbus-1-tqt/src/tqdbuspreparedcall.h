@@ -0,0 +1,281 @@
+/* tqdbuspreparedcall.h method calls and signals with a fixed header
+ *
+ * Licensed under the Academic Free License version 2.1
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ *
+ */
+
+#ifndef TQDBUSPREPAREDCALL_H
+#define TQDBUSPREPAREDCALL_H
+
+#include "tqdbusmacros.h"
+#include "tqdbusmessage.h"
+
+#include <tqcstring.h>
+#include <tqstring.h>
+#include <tqvaluelist.h>
+
+class TQT_DBusConnection;
+class TQT_DBusData;
+class TQT_DBusError;
+class TQObject;
+
+/**
+ * @brief A method call which is sent repeatedly with different arguments
+ *
+ * Creating a message through TQT_DBusMessage::methodCall() encodes the
+ * service name, object path, interface and method name every time the
+ * message is sent. A prepared call encodes them only once and keeps them
+ * in a template which each call is copied from, so only the arguments have
+ * to be marshalled for every call.
+ *
+ * Optionally the expected D-Bus signature of the arguments can be
+ * specified. Calls whose arguments do not match it are not sent.
+ *
+ * @code
+ *   TQT_DBusPreparedCall call(connection, "org.example.Service",
+ *                             "/org/example/Object", "org.example.Interface",
+ *                             "SetValue", "si");
+ *
+ *   TQValueList<TQT_DBusData> parameters;
+ *   parameters << TQT_DBusData::fromString("answer")
+ *              << TQT_DBusData::fromInt32(42);
+ *
+ *   TQT_DBusError error;
+ *   TQT_DBusMessage reply = call.sendWithReply(parameters, &error);
+ * @endcode
+ *
+ * @note The connection has to stay valid as long as the prepared call is
+ *       used
+ *
+ * @see TQT_DBusPreparedSignal
+ */
+class TQDBUS_EXPORT TQT_DBusPreparedCall
+{
+public:
+    /**
+     * @brief Creates a prepared call for the given method
+     *
+     * @param connection the connection to send the calls on
+     * @param service the D-Bus name of the peer
+     * @param path the object path of the peer's service object
+     * @param interface the interface the method belongs to
+     * @param method the name of the method to call
+     * @param signature the D-Bus signature the arguments have to match.
+     *        Can be empty to accept any arguments
+     *
+     * @see isValid()
+     */
+    TQT_DBusPreparedCall(const TQT_DBusConnection& connection,
+                         const TQString& service, const TQString& path,
+                         const TQString& interface, const TQString& method,
+                         const TQCString& signature = TQCString());
+
+    /**
+     * @brief Destroys the prepared call
+     */
+    ~TQT_DBusPreparedCall();
+
+    /**
+     * @brief Returns whether calls can be sent
+     *
+     * A prepared call is invalid if the header fields or the signature
+     * passed to the constructor are not valid D-Bus values.
+     *
+     * @return @c true if the template message could be created, otherwise
+     *         @c false
+     */
+    bool isValid() const;
+
+    /**
+     * @brief Returns the signature the arguments have to match
+     *
+     * @return the signature passed to the constructor
+     */
+    TQCString signature() const;
+
+    /**
+     * @brief Sets the timeout for calls waiting for a reply
+     *
+     * @param ms timeout in milliseconds, TQT_DBusMessage::NoTimeout to wait
+     *        forever or TQT_DBusMessage::DefaultTimeout for the
+     *        connection's default
+     *
+     * @see TQT_DBusMessage::setTimeout()
+     */
+    void setTimeout(int ms);
+
+    /**
+     * @brief Returns the timeout for calls waiting for a reply
+     *
+     * @return the timeout in milliseconds
+     *
+     * @see setTimeout()
+     */
+    int timeout() const;
+
+    /**
+     * @brief Creates a method call message with the given arguments
+     *
+     * The arguments are marshalled right away, sending the returned message
+     * does not marshall them again.
+     *
+     * @param args the arguments of the call
+     *
+     * @return the call message or an invalid message if the prepared call
+     *         is invalid or @p args does not match signature()
+     */
+    TQT_DBusMessage message(const TQValueList<TQT_DBusData>& args) const;
+
+    /**
+     * @brief Sends a call without waiting for a reply
+     *
+     * @param args the arguments of the call
+     *
+     * @return @c true if the call could be queued for sending, otherwise
+     *         @c false
+     *
+     * @see TQT_DBusConnection::send()
+     */
+    bool send(const TQValueList<TQT_DBusData>& args) const;
+
+    /**
+     * @brief Sends a call and waits for its reply
+     *
+     * @param args the arguments of the call
+     * @param error optional parameter for getting the error of a failed
+     *        call
+     *
+     * @return the reply message or an invalid message if the call failed
+     *
+     * @see TQT_DBusConnection::sendWithReply()
+     */
+    TQT_DBusMessage sendWithReply(const TQValueList<TQT_DBusData>& args,
+                                  TQT_DBusError* error = 0) const;
+
+    /**
+     * @brief Sends a call and delivers its reply to a slot
+     *
+     * @param args the arguments of the call
+     * @param receiver the object to deliver the reply to
+     * @param slot the slot receiving the reply as a TQT_DBusMessage
+     *
+     * @return the call's serial or @c 0 if sending failed
+     *
+     * @see TQT_DBusConnection::sendWithAsyncReply()
+     */
+    int sendWithAsyncReply(const TQValueList<TQT_DBusData>& args,
+                           TQObject* receiver, const char* slot) const;
+
+private:
+    class Private;
+    Private* d;
+
+    // not copyable
+    TQT_DBusPreparedCall(const TQT_DBusPreparedCall&);
+    TQT_DBusPreparedCall& operator=(const TQT_DBusPreparedCall&);
+};
+
+/**
+ * @brief A signal which is emitted repeatedly with different arguments
+ *
+ * The signal equivalent of TQT_DBusPreparedCall: the object path,
+ * interface and signal name are encoded only once, emitting the signal
+ * only marshalls its arguments.
+ *
+ * @code
+ *   TQT_DBusPreparedSignal signal(connection, "/org/example/Sensor",
+ *                                 "org.example.Sensor", "Measured", "d");
+ *
+ *   TQValueList<TQT_DBusData> args;
+ *   args << TQT_DBusData::fromDouble(value);
+ *
+ *   signal.send(args);
+ * @endcode
+ *
+ * @see TQT_DBusPreparedCall
+ */
+class TQDBUS_EXPORT TQT_DBusPreparedSignal
+{
+public:
+    /**
+     * @brief Creates a prepared signal
+     *
+     * @param connection the connection to emit the signal on
+     * @param path the object path of the emitting object
+     * @param interface the interface the signal belongs to
+     * @param member the name of the signal
+     * @param signature the D-Bus signature the arguments have to match.
+     *        Can be empty to accept any arguments
+     *
+     * @see isValid()
+     */
+    TQT_DBusPreparedSignal(const TQT_DBusConnection& connection,
+                           const TQString& path, const TQString& interface,
+                           const TQString& member,
+                           const TQCString& signature = TQCString());
+
+    /**
+     * @brief Destroys the prepared signal
+     */
+    ~TQT_DBusPreparedSignal();
+
+    /**
+     * @brief Returns whether the signal can be emitted
+     *
+     * @return @c true if the template message could be created, otherwise
+     *         @c false
+     */
+    bool isValid() const;
+
+    /**
+     * @brief Returns the signature the arguments have to match
+     *
+     * @return the signature passed to the constructor
+     */
+    TQCString signature() const;
+
+    /**
+     * @brief Creates a signal message with the given arguments
+     *
+     * @param args the arguments of the signal
+     *
+     * @return the signal message or an invalid message if the prepared
+     *         signal is invalid or @p args does not match signature()
+     */
+    TQT_DBusMessage message(const TQValueList<TQT_DBusData>& args) const;
+
+    /**
+     * @brief Emits the signal
+     *
+     * @param args the arguments of the signal
+     *
+     * @return @c true if the signal could be queued for sending, otherwise
+     *         @c false
+     */
+    bool send(const TQValueList<TQT_DBusData>& args) const;
+
+private:
+    class Private;
+    Private* d;
+
+    // not copyable
+    TQT_DBusPreparedSignal(const TQT_DBusPreparedSignal&);
+    TQT_DBusPreparedSignal& operator=(const TQT_DBusPreparedSignal&);
+};
+
+#endif
@@ -23,13 +23,26 @@
 
 #include "tqdbuserror.h"
 #include "tqdbusconnection.h"
+#include "tqdbusdata.h"
+#include "tqdbusdatalist.h"
+#include "tqdbusdatamap.h"
 #include "tqdbusmessage.h"
 #include "tqdbusproxy.h"
+#include "tqdbusvariant.h"
+
+#include <tqmap.h>
+#include <tqstringlist.h>
+
+static const char* propertiesInterface = "org.freedesktop.DBus.Properties";
 
 class TQT_DBusProxy::Private
 {
 public:
-    Private() : canSend(false) {}
+    Private() : canSend(false), signalsConnected(false),
+                timeout(TQT_DBusMessage::DefaultTimeout),
+                propertyCacheEnabled(false), propertiesConnected(false),
+                propertyCacheFilled(false), propertyCacheFailed(false),
+                propertyCacheHits(0), propertyCacheMisses(0) {}
     ~Private() {}
 
     void checkCanSend()
@@ -37,6 +50,102 @@ public:
         canSend = !path.isEmpty() && !service.isEmpty() && !interface.isEmpty();
     }
 
+    bool connectSignals(TQObject* receiver)
+    {
+        // remember the values of the match rule for releasing it later
+        matchService   = service;
+        matchPath      = path;
+        matchInterface = interface;
+
+        signalsConnected =
+            connection.connect(receiver, TQ_SLOT(handleDBusSignal(const TQT_DBusMessage&)),
+                               matchService, matchPath, matchInterface);
+
+        // whatever has been cached belongs to the previous peer, which
+        // includes a failure to fill the cache
+        propertyCache.clear();
+        propertyCacheFilled = false;
+        propertyCacheFailed = false;
+
+        if (propertyCacheEnabled) connectProperties(receiver);
+
+        return signalsConnected;
+    }
+
+    void disconnectSignals(TQObject* receiver)
+    {
+        disconnectProperties(receiver);
+
+        if (!signalsConnected) return;
+
+        connection.disconnect(receiver, TQ_SLOT(handleDBusSignal(const TQT_DBusMessage&)),
+                              matchService, matchPath, matchInterface);
+        signalsConnected = false;
+    }
+
+    void connectProperties(TQObject* receiver)
+    {
+        if (propertiesConnected || matchPath.isEmpty()) return;
+
+        propertiesConnected =
+            connection.connect(receiver,
+                               TQ_SLOT(handlePropertiesChanged(const TQT_DBusMessage&)),
+                               matchService, matchPath, propertiesInterface,
+                               "PropertiesChanged");
+    }
+
+    void disconnectProperties(TQObject* receiver)
+    {
+        if (!propertiesConnected) return;
+
+        connection.disconnect(receiver,
+                              TQ_SLOT(handlePropertiesChanged(const TQT_DBusMessage&)),
+                              matchService, matchPath, propertiesInterface,
+                              "PropertiesChanged");
+        propertiesConnected = false;
+    }
+
+    // a failure is remembered until the proxy's target changes, so an
+    // unreachable peer or one without the Properties interface is not
+    // called again on every property access
+    bool fillPropertyCache()
+    {
+        if (propertyCacheFailed) return false;
+
+        propertyCacheFailed = true;
+
+        if (!canSend || !connection.isConnected()) return false;
+
+        TQT_DBusMessage message =
+            TQT_DBusMessage::methodCall(service, path, propertiesInterface, "GetAll");
+        message.setTimeout(timeout);
+        message << TQT_DBusData::fromString(interface);
+
+        TQT_DBusMessage reply = connection.sendWithReply(message, &error);
+        if (reply.type() != TQT_DBusMessage::ReplyMessage || reply.count() != 1)
+            return false;
+
+        bool ok = false;
+        TQT_DBusDataMap<TQString> values = reply.front().toStringKeyMap(&ok);
+        if (!ok) return false;
+
+        // PropertiesChanged signals received while waiting for the reply
+        // are older than the reply's values
+        propertyCache.clear();
+
+        TQT_DBusDataMap<TQString>::const_iterator it    = values.begin();
+        TQT_DBusDataMap<TQString>::const_iterator endIt = values.end();
+        for (; it != endIt; ++it)
+        {
+            TQT_DBusVariant value = it.data().toVariant(&ok);
+            if (ok) propertyCache.insert(it.key(), value);
+        }
+
+        propertyCacheFilled = true;
+        propertyCacheFailed = false;
+        return true;
+    }
+
 public:
     TQT_DBusConnection connection;
 
@@ -45,7 +154,22 @@ public:
     TQString interface;
     bool canSend;
 
+    TQString matchService;
+    TQString matchPath;
+    TQString matchInterface;
+    bool signalsConnected;
+
+    int timeout;
+
     TQT_DBusError error;
+
+    bool propertyCacheEnabled;
+    bool propertiesConnected;
+    bool propertyCacheFilled;
+    bool propertyCacheFailed;
+    TQMap<TQString, TQT_DBusVariant> propertyCache;
+    uint propertyCacheHits;
+    uint propertyCacheMisses;
 };
 
 TQT_DBusProxy::TQT_DBusProxy(TQObject* parent, const char* name)
@@ -68,26 +192,28 @@ TQT_DBusProxy::TQT_DBusProxy(const TQString& service, const TQString& path,
     : TQObject(parent, (name ? name : "TQT_DBusProxy")),
       d(new Private())
 {
-    setConnection(connection);
-
     d->service = service;
     d->path = path;
     d->interface = interface;
     d->checkCanSend();
+
+    setConnection(connection);
 }
 
 TQT_DBusProxy::~TQT_DBusProxy()
 {
+    d->disconnectSignals(this);
+
     delete d;
 }
 
 bool TQT_DBusProxy::setConnection(const TQT_DBusConnection& connection)
 {
-    d->connection.disconnect(this, TQ_SLOT(handleDBusSignal(const TQT_DBusMessage&)));
+    d->disconnectSignals(this);
 
     d->connection = connection;
 
-    return d->connection.connect(this, TQ_SLOT(handleDBusSignal(const TQT_DBusMessage&)));
+    return d->connectSignals(this);
 }
 
 const TQT_DBusConnection& TQT_DBusProxy::connection() const
@@ -97,8 +223,14 @@ const TQT_DBusConnection& TQT_DBusProxy::connection() const
 
 void TQT_DBusProxy::setService(const TQString& service)
 {
+    if (d->service == service) return;
+
+    d->disconnectSignals(this);
+
     d->service = service;
     d->checkCanSend();
+
+    d->connectSignals(this);
 }
 
 TQString TQT_DBusProxy::service() const
@@ -108,8 +240,14 @@ TQString TQT_DBusProxy::service() const
 
 void TQT_DBusProxy::setPath(const TQString& path)
 {
+    if (d->path == path) return;
+
+    d->disconnectSignals(this);
+
     d->path = path;
     d->checkCanSend();
+
+    d->connectSignals(this);
 }
 
 TQString TQT_DBusProxy::path() const
@@ -119,8 +257,14 @@ TQString TQT_DBusProxy::path() const
 
 void TQT_DBusProxy::setInterface(const TQString& interface)
 {
+    if (d->interface == interface) return;
+
+    d->disconnectSignals(this);
+
     d->interface = interface;
     d->checkCanSend();
+
+    d->connectSignals(this);
 }
 
 TQString TQT_DBusProxy::interface() const
@@ -128,6 +272,16 @@ TQString TQT_DBusProxy::interface() const
     return d->interface;
 }
 
+void TQT_DBusProxy::setTimeout(int ms)
+{
+    d->timeout = ms < 0 ? TQT_DBusMessage::DefaultTimeout : ms;
+}
+
+int TQT_DBusProxy::timeout() const
+{
+    return d->timeout;
+}
+
 bool TQT_DBusProxy::canSend() const
 {
     return d->canSend && d->connection.isConnected();
@@ -135,26 +289,64 @@ bool TQT_DBusProxy::canSend() const
 
 bool TQT_DBusProxy::send(const TQString& method, const TQValueList<TQT_DBusData>& params) const
 {
-    if (!d->canSend || method.isEmpty() || !d->connection.isConnected())
+    TQT_DBusMessage message = methodCall(method);
+    if (message.type() == TQT_DBusMessage::InvalidMessage)
         return false;
 
-    TQT_DBusMessage message = TQT_DBusMessage::methodCall(d->service, d->path,
-                                                    d->interface, method);
     message += params;
 
-    return d->connection.send(message);
+    return send(message);
 }
 
 TQT_DBusMessage TQT_DBusProxy::sendWithReply(const TQString& method,
                                        const TQValueList<TQT_DBusData>& params,
                                        TQT_DBusError* error) const
 {
-    if (!d->canSend || method.isEmpty() || !d->connection.isConnected())
+    TQT_DBusMessage message = methodCall(method);
+    if (message.type() == TQT_DBusMessage::InvalidMessage)
+        return TQT_DBusMessage();
+
+    message += params;
+
+    return sendWithReply(message, error);
+}
+
+int TQT_DBusProxy::sendWithAsyncReply(const TQString& method, const TQValueList<TQT_DBusData>& params)
+{
+    TQT_DBusMessage message = methodCall(method);
+    if (message.type() == TQT_DBusMessage::InvalidMessage)
+        return 0;
+
+    message += params;
+
+    return sendWithAsyncReply(message);
+}
+
+TQT_DBusMessage TQT_DBusProxy::methodCall(const TQString& method) const
+{
+    if (!d->canSend || method.isEmpty())
         return TQT_DBusMessage();
 
     TQT_DBusMessage message = TQT_DBusMessage::methodCall(d->service, d->path,
                                                     d->interface, method);
-    message += params;
+    message.setTimeout(d->timeout);
+
+    return message;
+}
+
+bool TQT_DBusProxy::send(const TQT_DBusMessage& message) const
+{
+    if (message.type() != TQT_DBusMessage::MethodCallMessage || !d->connection.isConnected())
+        return false;
+
+    return d->connection.send(message);
+}
+
+TQT_DBusMessage TQT_DBusProxy::sendWithReply(const TQT_DBusMessage& message,
+                                           TQT_DBusError* error) const
+{
+    if (message.type() != TQT_DBusMessage::MethodCallMessage || !d->connection.isConnected())
+        return TQT_DBusMessage();
 
     TQT_DBusMessage reply = d->connection.sendWithReply(message, &d->error);
 
@@ -164,15 +356,11 @@ TQT_DBusMessage TQT_DBusProxy::sendWithReply(const TQString& method,
     return reply;
 }
 
-int TQT_DBusProxy::sendWithAsyncReply(const TQString& method, const TQValueList<TQT_DBusData>& params)
+int TQT_DBusProxy::sendWithAsyncReply(const TQT_DBusMessage& message)
 {
-    if (!d->canSend || method.isEmpty() || !d->connection.isConnected())
+    if (message.type() != TQT_DBusMessage::MethodCallMessage || !d->connection.isConnected())
         return 0;
 
-    TQT_DBusMessage message = TQT_DBusMessage::methodCall(d->service, d->path,
-                                                    d->interface, method);
-    message += params;
-
     return d->connection.sendWithAsyncReply(message, this,
                    TQ_SLOT(handleAsyncReply(const TQT_DBusMessage&)));
 }
@@ -182,20 +370,77 @@ TQT_DBusError TQT_DBusProxy::lastError() const
     return d->error;
 }
 
-void TQT_DBusProxy::handleDBusSignal(const TQT_DBusMessage& message)
+void TQT_DBusProxy::setPropertyCacheEnabled(bool enabled)
+{
+    if (d->propertyCacheEnabled == enabled) return;
+
+    d->propertyCacheEnabled = enabled;
+
+    d->propertyCache.clear();
+    d->propertyCacheFilled = false;
+    d->propertyCacheFailed = false;
+
+    if (enabled)
+    {
+        if (d->signalsConnected) d->connectProperties(this);
+    }
+    else
+        d->disconnectProperties(this);
+}
+
+bool TQT_DBusProxy::isPropertyCacheEnabled() const
+{
+    return d->propertyCacheEnabled;
+}
+
+bool TQT_DBusProxy::cachedProperty(const TQString& name, TQT_DBusVariant& value)
+{
+    if (!d->propertyCacheEnabled) return false;
+
+    if (!d->propertyCacheFilled && !d->fillPropertyCache())
+    {
+        ++d->propertyCacheMisses;
+        return false;
+    }
+
+    TQMap<TQString, TQT_DBusVariant>::const_iterator it = d->propertyCache.find(name);
+    if (it == d->propertyCache.end())
+    {
+        ++d->propertyCacheMisses;
+        return false;
+    }
+
+    ++d->propertyCacheHits;
+    value = it.data();
+    return true;
+}
+
+void TQT_DBusProxy::setCachedProperty(const TQString& name, const TQT_DBusVariant& value)
+{
+    if (!d->propertyCacheEnabled || !d->propertyCacheFilled) return;
+
+    d->propertyCache.insert(name, value);
+}
+
+void TQT_DBusProxy::invalidateCachedProperty(const TQString& name)
 {
-    if (!d->path.isEmpty() && d->path != message.path())
-        return;
+    d->propertyCache.remove(name);
+}
 
-    // only filter by service name if the name is a unique name
-    // because signals are always coming from a connection's unique name
-    // and filtering by a generic name would reject all signals
-    if (d->service.startsWith(":") && d->service != message.sender())
-        return;
+uint TQT_DBusProxy::propertyCacheHits() const
+{
+    return d->propertyCacheHits;
+}
 
-    if (!d->interface.isEmpty() && d->interface != message.interface())
-        return;
+uint TQT_DBusProxy::propertyCacheMisses() const
+{
+    return d->propertyCacheMisses;
+}
 
+void TQT_DBusProxy::handleDBusSignal(const TQT_DBusMessage& message)
+{
+    // the connection's signal routing has already filtered by path,
+    // interface and (if it is a unique name) service
     emit dbusSignal(message);
 }
 
@@ -206,4 +451,38 @@ void TQT_DBusProxy::handleAsyncReply(const TQT_DBusMessage& message)
     emit asyncReply(message.replySerialNumber(), message);
 }
 
+void TQT_DBusProxy::handlePropertiesChanged(const TQT_DBusMessage& message)
+{
+    // values arriving before the cache has been filled would make it look
+    // complete, GetAll will fetch them anyway
+    if (!d->propertyCacheFilled || message.count() != 3) return;
+
+    if (message[0].toString() != d->interface) return;
+
+    bool ok = false;
+    TQT_DBusDataMap<TQString> changed = message[1].toStringKeyMap(&ok);
+    if (ok)
+    {
+        TQT_DBusDataMap<TQString>::const_iterator it    = changed.begin();
+        TQT_DBusDataMap<TQString>::const_iterator endIt = changed.end();
+        for (; it != endIt; ++it)
+        {
+            TQT_DBusVariant value = it.data().toVariant(&ok);
+            if (ok)
+                d->propertyCache.insert(it.key(), value);
+            else
+                d->propertyCache.remove(it.key());
+        }
+    }
+
+    // invalidated properties are fetched again when they are next read
+    TQStringList invalidated = message[2].toList().toTQStringList();
+    TQStringList::const_iterator it    = invalidated.begin();
+    TQStringList::const_iterator endIt = invalidated.end();
+    for (; it != endIt; ++it)
+    {
+        d->propertyCache.remove(*it);
+    }
+}
+
 #include "tqdbusproxy.moc"
@@ -217,6 +217,7 @@ class TQT_DBusConnection;
 class TQT_DBusData;
 class TQT_DBusError;
 class TQT_DBusMessage;
+class TQT_DBusVariant;
 
 template <class T> class TQValueList;
 
@@ -403,6 +404,33 @@ public:
      */
     TQString interface() const;
 
+    /**
+     * @brief Sets the timeout for method calls sent by the proxy
+     *
+     * Limits how long sendWithReply() blocks and how long
+     * sendWithAsyncReply() waits before an error is delivered through
+     * asyncReply(). Both report an expired call as a
+     * TQT_DBusError::NoReply error.
+     *
+     * @param ms timeout in milliseconds, TQT_DBusMessage::NoTimeout to wait
+     *           as long as necessary or a negative value to use the
+     *           connection's default
+     *
+     * @see timeout()
+     * @see TQT_DBusConnection::setDefaultTimeout()
+     */
+    void setTimeout(int ms);
+
+    /**
+     * @brief Returns the timeout for method calls sent by the proxy
+     *
+     * @return the timeout in milliseconds or TQT_DBusMessage::DefaultTimeout
+     *         if the connection's default is used
+     *
+     * @see setTimeout()
+     */
+    int timeout() const;
+
     /**
      * @brief Returns whether the proxy can be used to send method calls
      *
@@ -498,6 +526,70 @@ public:
      */
     int sendWithAsyncReply(const TQString& method, const TQValueList<TQT_DBusData>& params);
 
+    /**
+     * @brief Creates a method call to the peer object
+     *
+     * The message is addressed to the proxy's service, path and interface
+     * and uses the proxy's timeout. Arguments can then be added, e.g.
+     * directly from native values through TQT_DBusMessage::append(), before
+     * sending it with one of the message based send methods.
+     *
+     * @code
+     *   TQT_DBusMessage message = proxy.methodCall("Move");
+     *   message.append<TQPoint>(position);
+     *
+     *   TQT_DBusMessage reply = proxy.sendWithReply(message);
+     * @endcode
+     *
+     * @param method the name of the method to invoke
+     *
+     * @return the method call message or an invalid message if the method
+     *         name is empty or any of the conditions for canSend() are not
+     *         met
+     *
+     * @see @ref dbusconventions-membername
+     */
+    TQT_DBusMessage methodCall(const TQString& method) const;
+
+    /**
+     * @brief Sends a method call created with methodCall()
+     *
+     * @param message the method call message
+     *
+     * @return @c true if sending succeeded, @c false if sending failed or
+     *         @p message is not a method call
+     *
+     * @see send(const TQString&, const TQValueList<TQT_DBusData>&) const
+     */
+    bool send(const TQT_DBusMessage& message) const;
+
+    /**
+     * @brief Sends a method call created with methodCall() and waits for
+     *        the reply
+     *
+     * @param message the method call message
+     * @param error optional parameter to get any error directly
+     *
+     * @return the reply message or an invalid message if an error occurs
+     *
+     * @see sendWithReply(const TQString&, const TQValueList<TQT_DBusData>&, TQT_DBusError*) const
+     */
+    TQT_DBusMessage sendWithReply(const TQT_DBusMessage& message,
+                                  TQT_DBusError* error = 0) const;
+
+    /**
+     * @brief Sends a method call created with methodCall() but does not
+     *        wait for an answer
+     *
+     * @param message the method call message
+     *
+     * @return a serial number to identify the reply delivered through
+     *         asyncReply() or 0 if the call is not possible
+     *
+     * @see sendWithAsyncReply(const TQString&, const TQValueList<TQT_DBusData>&)
+     */
+    int sendWithAsyncReply(const TQT_DBusMessage& message);
+
     /**
      * @brief Returns the last error seen by the proxy
      *
@@ -509,6 +601,100 @@ public:
      */
     TQT_DBusError lastError() const;
 
+    /**
+     * @brief Enables or disables caching of the peer object's properties
+     *
+     * When enabled, the first lookup through cachedProperty() fetches all
+     * properties of the proxy's interface with a single
+     * @c org.freedesktop.DBus.Properties.GetAll call. The cached values
+     * are then kept current from the peer's @c PropertiesChanged signals,
+     * so further lookups do not need any D-Bus round-trip.
+     *
+     * Properties the peer only reports as invalidated are removed from the
+     * cache and have to be fetched again, see setCachedProperty().
+     *
+     * The cache is cleared whenever it is disabled or the proxy's
+     * connection, service, path or interface change.
+     *
+     * @note Only useful if the peer emits @c PropertiesChanged, otherwise
+     *       the cached values will become stale
+     *
+     * @param enabled @c true to enable the cache, @c false to disable it
+     *
+     * @see isPropertyCacheEnabled()
+     */
+    void setPropertyCacheEnabled(bool enabled);
+
+    /**
+     * @brief Returns whether the peer object's properties are cached
+     *
+     * @return @c true if the property cache is enabled, otherwise @c false
+     *
+     * @see setPropertyCacheEnabled()
+     */
+    bool isPropertyCacheEnabled() const;
+
+    /**
+     * @brief Looks up a property in the property cache
+     *
+     * Fills the cache first if this has not happened yet. If filling the
+     * cache fails, it is not attempted again until the proxy's connection,
+     * service, path or interface change or the cache is enabled again.
+     *
+     * Each lookup of an enabled cache is counted as either a hit or a miss,
+     * see propertyCacheHits() and propertyCacheMisses()
+     *
+     * @param name the name of the property
+     * @param value variable to store the property's value into
+     *
+     * @return @c true if the property has been found in the cache,
+     *         @c false if it has not or if the cache is not enabled
+     *
+     * @see setPropertyCacheEnabled()
+     */
+    bool cachedProperty(const TQString& name, TQT_DBusVariant& value);
+
+    /**
+     * @brief Stores a property value fetched after a cache miss
+     *
+     * Does nothing if the cache is not enabled or has not been filled yet.
+     *
+     * @param name the name of the property
+     * @param value the property's current value
+     *
+     * @see cachedProperty()
+     */
+    void setCachedProperty(const TQString& name, const TQT_DBusVariant& value);
+
+    /**
+     * @brief Removes a property from the property cache
+     *
+     * E.g. after setting it, since the peer might store a different value
+     * than the one it has been given.
+     *
+     * @param name the name of the property
+     */
+    void invalidateCachedProperty(const TQString& name);
+
+    /**
+     * @brief Returns the number of lookups answered by the property cache
+     *
+     * @return the number of successful cachedProperty() calls
+     *
+     * @see propertyCacheMisses()
+     */
+    uint propertyCacheHits() const;
+
+    /**
+     * @brief Returns the number of lookups not answered by the property cache
+     *
+     * @return the number of unsuccessful cachedProperty() calls while the
+     *         cache was enabled
+     *
+     * @see propertyCacheHits()
+     */
+    uint propertyCacheMisses() const;
+
 signals:
     /**
      * @brief Signal emitted for D-Bus signals from the peer
@@ -572,6 +758,11 @@ protected slots:
      */
     virtual void handleAsyncReply(const TQT_DBusMessage& message);
 
+private slots:
+    // updates the property cache from a PropertiesChanged signal, only
+    // connected while the property cache is enabled
+    void handlePropertiesChanged(const TQT_DBusMessage& message);
+
 private:
   class Private;
   Private* d;
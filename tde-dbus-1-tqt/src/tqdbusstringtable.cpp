@@ -0,0 +1,68 @@
+/* tqdbusstringtable.cpp shared strings for message header fields
+ *
+ * Licensed under the Academic Free License version 2.1
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ *
+ */
+
+#include "tqdbusstringtable_p.h"
+
+static TQString fromHeaderField(const char* utf8)
+{
+    // names are ASCII except for paths, which rarely are not
+    for (const char* c = utf8; *c != '\0'; ++c)
+    {
+        if ((unsigned char)*c >= 0x80)
+            return TQString::fromUtf8(utf8);
+    }
+
+    return TQString::fromLatin1(utf8);
+}
+
+TQT_DBusStringTable::TQT_DBusStringTable(uint maxStrings)
+    : m_strings(257), m_maxStrings(maxStrings)
+{
+    m_strings.setAutoDelete(true);
+}
+
+TQString TQT_DBusStringTable::string(const char* utf8)
+{
+    if (utf8 == 0) return TQString::null;
+
+    if (utf8[0] == ':') return fromHeaderField(utf8);
+
+    TQString* string = m_strings.find(utf8);
+    if (string != 0) return *string;
+
+    // the strings in use are added again by the next messages
+    if (m_strings.count() >= m_maxStrings)
+        m_strings.clear();
+
+    // keep the dictionary sparse enough for constant time lookups
+    if (m_strings.count() >= m_strings.size())
+        m_strings.resize(m_strings.size() * 2 + 1);
+
+    string = new TQString(fromHeaderField(utf8));
+    m_strings.insert(utf8, string);
+
+    return *string;
+}
+
+void TQT_DBusStringTable::clear()
+{
+    m_strings.clear();
+}
@@ -0,0 +1,72 @@
+/* tqdbusstringtable_p.h shared strings for message header fields
+ *
+ * Licensed under the Academic Free License version 2.1
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ *
+ */
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the public API.  This header file may
+// change from version to version without notice, or even be
+// removed.
+//
+// We mean it.
+//
+//
+
+#ifndef TQDBUSSTRINGTABLE_P_H
+#define TQDBUSSTRINGTABLE_P_H
+
+#include <tqasciidict.h>
+#include <tqstring.h>
+
+// Intern table for the path, interface, member and sender of incoming
+// messages.
+//
+// Strings are looked up by their UTF-8 encoding, so a name seen before is
+// neither converted nor allocated again and all messages carrying it share
+// the same TQString data.
+//
+// Not thread-safe, and neither are the reference counts of the strings it
+// hands out, so a table is only used on the thread dispatching messages.
+class TQT_DBusStringTable
+{
+public:
+    // unique connection names (":1.42") are converted but never kept, since
+    // each peer has a new one. Once maxStrings are stored the table starts
+    // over, so strings which are no longer used do not stay forever
+    TQT_DBusStringTable(uint maxStrings = 1024);
+
+    TQString string(const char* utf8);
+
+    uint count() const { return m_strings.count(); }
+    void clear();
+
+private:
+    // not copyable
+    TQT_DBusStringTable(const TQT_DBusStringTable&);
+    TQT_DBusStringTable& operator=(const TQT_DBusStringTable&);
+
+private:
+    TQAsciiDict<TQString> m_strings;
+    uint m_maxStrings;
+};
+
+#endif
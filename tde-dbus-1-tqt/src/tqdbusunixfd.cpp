@@ -22,17 +22,30 @@
  */
 
 #include <unistd.h> 
+#include "tqdbusatomic.h"
 #include "tqdbusunixfd.h"
 
+// TQShared::ref()/deref() are not thread-safe, the count is changed
+// atomically instead
+static inline void qRefUnixFd(TQShared* shared)
+{
+    Atomic::increment(shared->count);
+}
+
+static inline bool qDerefUnixFd(TQShared* shared)
+{
+    return Atomic::decrement(shared->count) == 0;
+}
+
+// a new TQShared already holds the reference of its creator
 TQT_DBusUnixFd::TQT_DBusUnixFd() : d(new TQT_DBusUnixFdPrivate())
 {
-    d->ref();
     d->fd = -1;
 };
 
 TQT_DBusUnixFd::TQT_DBusUnixFd(const TQT_DBusUnixFd& other) : d(other.d)
 {
-    d->ref();
+    if (d) qRefUnixFd(d);
 }
 
 TQT_DBusUnixFd::TQT_DBusUnixFd(int other) : d(0)
@@ -42,7 +55,7 @@ TQT_DBusUnixFd::TQT_DBusUnixFd(int other) : d(0)
 
 TQT_DBusUnixFd::~TQT_DBusUnixFd()
 {
-    if (d && d->deref() ) {
+    if (d && qDerefUnixFd(d) ) {
         if ( isValid() ) {
             close(d->fd);
         }
@@ -67,24 +80,25 @@ void TQT_DBusUnixFd::setFileDescriptor(int fileDescriptor)
 
 void TQT_DBusUnixFd::giveFileDescriptor(int fileDescriptor) 
 {
-    if ( d && d->deref() ) {
+    if ( d && qDerefUnixFd(d) ) {
         if ( isValid() ) {
             close(d->fd);
         }
+        // reuse it, taking the reference just released
+        qRefUnixFd(d);
     }
     else {
         d = new TQT_DBusUnixFdPrivate;
     }
-    d->ref();
     d->fd = fileDescriptor;
 }
 
 TQT_DBusUnixFd &TQT_DBusUnixFd::operator=( const TQT_DBusUnixFd &other )
 {
     if (other.d) {
-        other.d->ref();
+        qRefUnixFd(other.d);
     }
-    if ( d && d->deref() ) {
+    if ( d && qDerefUnixFd(d) ) {
         if ( isValid() ) {
             close(d->fd);
         }
@@ -0,0 +1,251 @@
+/* tqdbusworkerpool.cpp threads for handling method calls of service objects
+ *
+ * Licensed under the Academic Free License version 2.1
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ *
+ */
+
+#include "tqdbusworkerpool_p.h"
+
+#include <tqthread.h>
+
+#include "tqdbusconnection_p.h"
+#include "tqdbusmarshall.h"
+#include "tqdbusmessage.h"
+
+class TQT_DBusWorker : public TQThread
+{
+public:
+    TQT_DBusWorker(TQT_DBusWorkerPool* pool) : m_pool(pool) {}
+
+protected:
+    virtual void run()
+    {
+        TQT_DBusWorkerPool::Call call;
+        while (m_pool->takeCall(call))
+        {
+            m_pool->runCall(call);
+            m_pool->finishCall(call);
+        }
+
+        // the thread is gone after this, so is its cache
+        TQT_DBusMarshall::releaseThreadCache();
+    }
+
+private:
+    TQT_DBusWorkerPool* m_pool;
+};
+
+TQT_DBusWorkerPool::TQT_DBusWorkerPool(TQT_DBusConnectionPrivate* connection, uint threads)
+    : m_connection(connection), m_stopping(false)
+{
+    m_workers.setAutoDelete(true);
+
+    for (uint i = 0; i < threads; ++i)
+    {
+        TQT_DBusWorker* worker = new TQT_DBusWorker(this);
+        m_workers.append(worker);
+        worker->start();
+    }
+}
+
+TQT_DBusWorkerPool::~TQT_DBusWorkerPool()
+{
+    m_mutex.lock();
+
+    m_stopping = true;
+
+    CallList::const_iterator it    = m_calls.begin();
+    CallList::const_iterator endIt = m_calls.end();
+    for (; it != endIt; ++it)
+    {
+        dbus_message_unref((*it).message);
+    }
+    m_calls.clear();
+
+    m_callsChanged.wakeAll();
+    m_mutex.unlock();
+
+    TQPtrListIterator<TQT_DBusWorker> workerIt(m_workers);
+    for (; workerIt.current() != 0; ++workerIt)
+    {
+        workerIt.current()->wait();
+    }
+    m_workers.clear();
+}
+
+void TQT_DBusWorkerPool::setConcurrency(TQT_DBusObjectBase* object, uint maxCalls)
+{
+    if (maxCalls == 0)
+    {
+        // new calls are only enqueued by the GUI thread, i.e. the caller
+        drain(object);
+
+        m_mutex.lock();
+        m_objects.remove(object);
+        m_mutex.unlock();
+        return;
+    }
+
+    m_mutex.lock();
+    m_objects[object].maxCalls = maxCalls;
+    m_callsChanged.wakeAll();
+    m_mutex.unlock();
+}
+
+uint TQT_DBusWorkerPool::concurrency(TQT_DBusObjectBase* object)
+{
+    m_mutex.lock();
+    ObjectMap::const_iterator it = m_objects.find(object);
+    uint maxCalls = (it != m_objects.end()) ? it.data().maxCalls : 0;
+    m_mutex.unlock();
+
+    return maxCalls;
+}
+
+bool TQT_DBusWorkerPool::enqueue(TQT_DBusObjectBase* object, DBusMessage* message)
+{
+    m_mutex.lock();
+
+    ObjectMap::iterator it = m_objects.find(object);
+    if (it == m_objects.end() || m_stopping)
+    {
+        m_mutex.unlock();
+        return false;
+    }
+
+    // built in place, a local copy would share the sender with the list
+    // and release it after the mutex is unlocked
+    CallList::iterator callIt = m_calls.append(Call());
+    (*callIt).object  = object;
+    (*callIt).message = dbus_message_ref(message);
+    (*callIt).sender  = dbus_message_get_sender(message);
+
+    ++it.data().queued;
+
+    m_callsChanged.wakeAll();
+    m_mutex.unlock();
+
+    return true;
+}
+
+void TQT_DBusWorkerPool::drain(TQT_DBusObjectBase* object)
+{
+    m_mutex.lock();
+
+    while (true)
+    {
+        ObjectMap::const_iterator it = m_objects.find(object);
+        if (it == m_objects.end() || (it.data().queued == 0 && it.data().running == 0))
+            break;
+
+        m_callsChanged.wait(&m_mutex);
+    }
+
+    m_mutex.unlock();
+}
+
+bool TQT_DBusWorkerPool::takeCall(Call& call)
+{
+    m_mutex.lock();
+
+    while (!m_stopping)
+    {
+        CallList::iterator it    = m_calls.begin();
+        CallList::iterator endIt = m_calls.end();
+        while (it != endIt)
+        {
+            ObjectMap::iterator objectIt = m_objects.find((*it).object);
+            if (objectIt == m_objects.end())
+            {
+                // the object has left the pool, its call is dropped
+                dbus_message_unref((*it).message);
+                it = m_calls.remove(it);
+                continue;
+            }
+
+            ObjectState& state = objectIt.data();
+            if (state.running >= state.maxCalls || state.busySenders.contains((*it).sender))
+            {
+                // keeps the calls of each sender in order
+                ++it;
+                continue;
+            }
+
+            call = *it;
+            m_calls.remove(it);
+
+            --state.queued;
+            ++state.running;
+            state.busySenders.insert(call.sender.copy(), true);
+
+            m_mutex.unlock();
+            return true;
+        }
+
+        m_callsChanged.wait(&m_mutex);
+    }
+
+    m_mutex.unlock();
+    return false;
+}
+
+void TQT_DBusWorkerPool::finishCall(const Call& call)
+{
+    m_mutex.lock();
+
+    ObjectMap::iterator it = m_objects.find(call.object);
+    if (it != m_objects.end())
+    {
+        --it.data().running;
+        it.data().busySenders.remove(call.sender);
+    }
+
+    m_callsChanged.wakeAll();
+    m_mutex.unlock();
+
+    dbus_message_unref(call.message);
+}
+
+void TQT_DBusWorkerPool::runCall(const Call& call)
+{
+    bool handled = false;
+    {
+        // created and destroyed on this thread
+        TQT_DBusMessage message = TQT_DBusMessage::fromDBusMessage(call.message);
+        handled = TQT_DBusConnectionPrivate::callObject(call.object, message);
+    }
+
+    // the filter has already claimed the message, so the error libdbus would
+    // send for unhandled calls has to be sent here
+    if (handled || dbus_message_get_no_reply(call.message))
+        return;
+
+    const char* interface = dbus_message_get_interface(call.message);
+
+    DBusMessage* error =
+        dbus_message_new_error_printf(call.message, DBUS_ERROR_UNKNOWN_METHOD,
+                                      "Method \"%s\" with signature \"%s\" on interface \"%s\" doesn't exist\n",
+                                      dbus_message_get_member(call.message),
+                                      dbus_message_get_signature(call.message),
+                                      interface != 0 ? interface : "(null)");
+    if (error != 0)
+    {
+        m_connection->sendFromAnyThread(error);
+        dbus_message_unref(error);
+    }
+}
@@ -0,0 +1,124 @@
+/* tqdbusworkerpool_p.h threads for handling method calls of service objects
+ *
+ * Licensed under the Academic Free License version 2.1
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301,
+ * USA.
+ *
+ */
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the public API.  This header file may
+// change from version to version without notice, or even be
+// removed.
+//
+// We mean it.
+//
+//
+
+#ifndef TQDBUSWORKERPOOL_P_H
+#define TQDBUSWORKERPOOL_P_H
+
+#include <tqcstring.h>
+#include <tqmap.h>
+#include <tqmutex.h>
+#include <tqptrlist.h>
+#include <tqvaluelist.h>
+#include <tqwaitcondition.h>
+
+#include <dbus/dbus.h>
+
+class TQT_DBusConnectionPrivate;
+class TQT_DBusObjectBase;
+class TQT_DBusWorker;
+
+// Runs method calls of service objects on a fixed number of threads.
+//
+// Each object has a limit on the number of its calls running at the same
+// time. Calls from the same sender to the same object are run one after
+// the other in the order they have been received.
+//
+// All members are protected by the pool's mutex. The TQCString values are
+// only ever touched with the mutex held, since their reference counts are
+// not thread-safe.
+class TQT_DBusWorkerPool
+{
+    friend class TQT_DBusWorker;
+public:
+    TQT_DBusWorkerPool(TQT_DBusConnectionPrivate* connection, uint threads);
+
+    // waits for the running calls, queued ones are dropped
+    ~TQT_DBusWorkerPool();
+
+    // a limit of 0 makes the object's calls run on the GUI thread again,
+    // after waiting for the ones already accepted by the pool
+    void setConcurrency(TQT_DBusObjectBase* object, uint maxCalls);
+    uint concurrency(TQT_DBusObjectBase* object);
+
+    // takes a reference of the message if the object's calls are handled by
+    // the pool, otherwise returns false
+    bool enqueue(TQT_DBusObjectBase* object, DBusMessage* message);
+
+    // waits until the object has no queued or running calls
+    void drain(TQT_DBusObjectBase* object);
+
+private:
+    struct Call
+    {
+        TQT_DBusObjectBase* object;
+        DBusMessage* message;
+        TQCString sender;
+    };
+    typedef TQValueList<Call> CallList;
+
+    struct ObjectState
+    {
+        ObjectState() : maxCalls(0), queued(0), running(0) {}
+
+        uint maxCalls;
+        uint queued;
+        uint running;
+
+        // senders with a call of theirs currently running
+        TQMap<TQCString, bool> busySenders;
+    };
+    typedef TQMap<TQT_DBusObjectBase*, ObjectState> ObjectMap;
+
+    // called by the workers
+    bool takeCall(Call& call);
+    void finishCall(const Call& call);
+    void runCall(const Call& call);
+
+    // not copyable
+    TQT_DBusWorkerPool(const TQT_DBusWorkerPool&);
+    TQT_DBusWorkerPool& operator=(const TQT_DBusWorkerPool&);
+
+private:
+    TQT_DBusConnectionPrivate* m_connection;
+
+    TQMutex m_mutex;
+    TQWaitCondition m_callsChanged;
+
+    bool m_stopping;
+    CallList m_calls;
+    ObjectMap m_objects;
+
+    TQPtrList<TQT_DBusWorker> m_workers;
+};
+
+#endif